@@ -0,0 +1,351 @@
+// 端到端基准：对目录下每一页执行 detectLayout + 区域OCR，输出各阶段延迟分位数与吞吐(JSON)
+// --instances N 时创建N个OcrLite，各用一个线程并发处理页面，对比实例数对RSS的影响
+// --layoutFast 开启版面级联，另外按结果来自哪一级统计版面耗时与页数
+// --refilter 计时结束后逐页比较 整页推理 与 换阈值重新后处理（refilter）的耗时
+#include <getopt.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/imgcodecs.hpp>
+#include "BenchUtils.h"
+#include "OcrLite.h"
+#include "OcrUtils.h"
+#include "OcrTrace.h"
+
+static const char *STAGE_NAMES[] = {"layout", "region_ocr", "total"};
+// 级联时按LayoutResult::stage分别统计版面耗时，下标与LayoutStage一致
+static const char *CASCADE_NAMES[] = {"layout_full", "layout_fast", "layout_escalated"};
+static const char *REFILTER_NAMES[] = {"layout_detect", "layout_refilter", "ocr_detect", "ocr_refilter"};
+
+static std::vector<std::string> listPages(const std::string &dir) {
+    static const char *exts[] = {".jpg", ".jpeg", ".png", ".bmp", ".tif", ".tiff", ".webp"};
+    std::vector<std::string> pages;
+    for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+        if (!entry.is_regular_file()) continue;
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        for (const char *e : exts) {
+            if (ext == e) {
+                pages.push_back(entry.path().string());
+                break;
+            }
+        }
+    }
+    std::sort(pages.begin(), pages.end());
+    return pages;
+}
+
+static std::string statsToJson(const BenchStats &stats, double totalMs) {
+    char buf[512];
+    snprintf(buf, sizeof(buf),
+             "{\"count\": %d, \"mean_ms\": %.3f, \"p50_ms\": %.3f, \"p90_ms\": %.3f, "
+             "\"p99_ms\": %.3f, \"max_ms\": %.3f, \"pages_per_sec\": %.3f}",
+             stats.count, stats.mean, stats.p50, stats.p90, stats.p99, stats.max,
+             totalMs > 0 ? stats.count * 1000.0 / totalMs : 0.0);
+    return buf;
+}
+
+static void printUsage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s --models DIR --pages DIR [options]\n"
+            "  -d, --models DIR             models directory (OcrEngine.kt file names)\n"
+            "  -P, --pages DIR              directory of page images\n"
+            "  -w, --warmup N               warm-up passes over all pages (default 1)\n"
+            "  -n, --iterations N           timed passes over all pages (default 3)\n"
+            "  -t, --numThread N            threads per net (default 4)\n"
+            "  -L, --layoutScoreThresh F    (default 0.1)\n"
+            "  -r, --regionOcr 0|1          OCR text regions after layout (default 1)\n"
+            "  -j, --json PATH              write the JSON report to PATH instead of stdout\n"
+            "  -T, --trace PATH             write a Chrome trace-event JSON of the timed passes\n"
+            "  -C, --cacheDir DIR           cache optimized models (ORT format) in DIR\n"
+            "  -I, --instances N            concurrent OcrLite instances, one thread each (default 1)\n"
+            "  -A, --sharedArena            all sessions share one CPU arena on the ORT env\n"
+            "  -F, --layoutFast NAME        cascade: small layout model in DIR first, full model on gate failure\n"
+            "  -b, --batch N                pages per LayoutNet run via detectLayoutBatch (default 1);\n"
+            "                               layout time per page is the batch time divided by N\n"
+            "  -R, --refilter               also time re-thresholding cached outputs against full runs\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    std::string modelsDir = ".";
+    std::string pagesDir;
+    std::string jsonPath;
+    std::string tracePath;
+    std::string cacheDir;
+    int warmup = 1;
+    int iterations = 3;
+    int numThread = 4;
+    int instances = 1;
+    int batch = 1;
+    std::string layoutFastName;
+    bool sharedArena = false;
+    float layoutScoreThresh = 0.1f;
+    bool regionOcr = true;
+    bool refilter = false;
+    // 区域OCR参数与 OcrEngine.kt 默认值一致
+    const int padding = 50;
+    const float boxScoreThresh = 0.3f;
+    const float boxThresh = 0.15f;
+    const float unClipRatio = 1.6f;
+
+    static const struct option longOptions[] = {
+            {"models",            required_argument, NULL, 'd'},
+            {"pages",             required_argument, NULL, 'P'},
+            {"warmup",            required_argument, NULL, 'w'},
+            {"iterations",        required_argument, NULL, 'n'},
+            {"numThread",         required_argument, NULL, 't'},
+            {"layoutScoreThresh", required_argument, NULL, 'L'},
+            {"regionOcr",         required_argument, NULL, 'r'},
+            {"json",              required_argument, NULL, 'j'},
+            {"trace",             required_argument, NULL, 'T'},
+            {"cacheDir",          required_argument, NULL, 'C'},
+            {"instances",         required_argument, NULL, 'I'},
+            {"sharedArena",       no_argument,       NULL, 'A'},
+            {"batch",             required_argument, NULL, 'b'},
+            {"layoutFast",        required_argument, NULL, 'F'},
+            {"refilter",          no_argument,       NULL, 'R'},
+            {"help",              no_argument,       NULL, 'h'},
+            {NULL,                no_argument,       NULL, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "d:P:w:n:t:L:r:j:T:C:I:Ab:F:Rh", longOptions, NULL)) != -1) {
+        switch (opt) {
+            case 'd': modelsDir = optarg; break;
+            case 'P': pagesDir = optarg; break;
+            case 'w': warmup = atoi(optarg); break;
+            case 'n': iterations = atoi(optarg); break;
+            case 't': numThread = atoi(optarg); break;
+            case 'L': layoutScoreThresh = strtof(optarg, NULL); break;
+            case 'r': regionOcr = atoi(optarg) != 0; break;
+            case 'j': jsonPath = optarg; break;
+            case 'T': tracePath = optarg; break;
+            case 'C': cacheDir = optarg; break;
+            case 'I': instances = (std::max)(1, atoi(optarg)); break;
+            case 'A': sharedArena = true; break;
+            case 'b': batch = (std::max)(1, atoi(optarg)); break;
+            case 'F': layoutFastName = optarg; break;
+            case 'R': refilter = true; break;
+            default:
+                printUsage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (pagesDir.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<std::string> pagePaths = listPages(pagesDir);
+    std::vector<cv::Mat> pages;
+    for (const auto &path : pagePaths) {
+        cv::Mat img = cv::imread(path, cv::IMREAD_COLOR);
+        if (img.empty()) {
+            LOGW("skip unreadable page: %s", path.c_str());
+            continue;
+        }
+        pages.push_back(img);
+    }
+    if (pages.empty()) {
+        LOGE("no pages found in %s", pagesDir.c_str());
+        return 1;
+    }
+
+    std::string dir = modelsDir.back() == '/' ? modelsDir : modelsDir + "/";
+    setOrtSharedAllocator(sharedArena);
+    size_t rssBefore = getResidentBytes();
+    std::vector<std::unique_ptr<OcrLite>> engines;
+    for (int i = 0; i < instances; ++i) {
+        engines.emplace_back(new OcrLite());
+        OcrLite &ocrLite = *engines.back();
+        ocrLite.setCacheDir(cacheDir);
+        if (!layoutFastName.empty()) ocrLite.setLayoutCascade(dir + layoutFastName);
+        try {
+            ocrLite.init(numThread, dir + "ch_PP-OCRv3_det_infer.onnx",
+                         dir + "ch_ppocr_mobile_v2.0_cls_infer.onnx",
+                         dir + "ch_PP-OCRv3_rec_infer.onnx", dir + "ppocr_keys_v1.vocab",
+                         dir + "doclayout_yolo_docstructbench_imgsz1024.onnx");
+        } catch (const std::exception &e) {
+            LOGE("init failed: %s", e.what());
+            return 1;
+        }
+    }
+    size_t rssAfterInit = getResidentBytes();
+
+    // 每个实例一个线程，按页序号轮流分配；各线程的样本最后合并
+    std::vector<std::map<std::string, std::vector<double>>> instanceSamples(instances);
+    auto runPage = [&](OcrLite &ocrLite, cv::Mat &page, bool record,
+                       std::map<std::string, std::vector<double>> &samples) {
+        double start = benchNowMs();
+        LayoutResult layoutResult = ocrLite.detectLayout(page, layoutScoreThresh);
+        double layoutEnd = benchNowMs();
+        if (regionOcr) {
+            ocrLite.recognizeLayoutRegions(page, layoutResult, padding, boxScoreThresh,
+                                           boxThresh, unClipRatio, true, true);
+        }
+        double end = benchNowMs();
+        if (record) {
+            samples["layout"].push_back(layoutEnd - start);
+            samples[CASCADE_NAMES[static_cast<int>(layoutResult.stage)]].push_back(layoutEnd - start);
+            samples["region_ocr"].push_back(end - layoutEnd);
+            samples["total"].push_back(end - start);
+        }
+    };
+
+    // 一批页面一次LayoutNet推理，版面耗时按页数均摊；区域OCR仍逐页
+    auto runBatch = [&](OcrLite &ocrLite, std::vector<cv::Mat> &batchPages, bool record,
+                        std::map<std::string, std::vector<double>> &samples) {
+        double start = benchNowMs();
+        std::vector<LayoutResult> layoutResults = ocrLite.detectLayoutBatch(batchPages,
+                                                                            layoutScoreThresh, batch);
+        double layoutMs = (benchNowMs() - start) / batchPages.size();
+        for (size_t i = 0; i < batchPages.size(); ++i) {
+            double ocrStart = benchNowMs();
+            if (regionOcr) {
+                ocrLite.recognizeLayoutRegions(batchPages[i], layoutResults[i], padding,
+                                               boxScoreThresh, boxThresh, unClipRatio, true, true);
+            }
+            double ocrMs = benchNowMs() - ocrStart;
+            if (record) {
+                samples["layout"].push_back(layoutMs);
+                samples[CASCADE_NAMES[static_cast<int>(layoutResults[i].stage)]].push_back(layoutMs);
+                samples["region_ocr"].push_back(ocrMs);
+                samples["total"].push_back(layoutMs + ocrMs);
+            }
+        }
+    };
+
+    auto runPass = [&](bool record) {
+        std::vector<std::thread> workers;
+        for (int k = 0; k < instances; ++k) {
+            workers.emplace_back([&, k]() {
+                // detectLayout/recognizeLayoutRegions只读页面，各线程可直接共用
+                if (batch <= 1) {
+                    for (size_t p = k; p < pages.size(); p += instances) {
+                        runPage(*engines[k], pages[p], record, instanceSamples[k]);
+                    }
+                    return;
+                }
+                std::vector<cv::Mat> batchPages;
+                for (size_t p = k; p < pages.size(); p += instances) {
+                    batchPages.push_back(pages[p]);
+                    if ((int) batchPages.size() == batch) {
+                        runBatch(*engines[k], batchPages, record, instanceSamples[k]);
+                        batchPages.clear();
+                    }
+                }
+                if (!batchPages.empty()) runBatch(*engines[k], batchPages, record, instanceSamples[k]);
+            });
+        }
+        for (auto &worker : workers) worker.join();
+    };
+
+    for (int i = 0; i < warmup; ++i) runPass(false);
+    if (!tracePath.empty()) OcrTrace::start();
+    double wallStart = benchNowMs();
+    for (int i = 0; i < iterations; ++i) runPass(true);
+    double wallMs = benchNowMs() - wallStart;
+    size_t rssAfterRun = getResidentBytes();
+    std::map<std::string, std::vector<double>> samples;
+    for (auto &perInstance : instanceSamples) {
+        for (auto &stage : perInstance) {
+            samples[stage.first].insert(samples[stage.first].end(), stage.second.begin(),
+                                        stage.second.end());
+        }
+    }
+    if (!tracePath.empty()) {
+        OcrTrace::stop();
+        OcrTrace::writeJson(tracePath);
+    }
+
+    if (refilter) {
+        // 整页跑一次并缓存输出，再把各阈值提高0.1重新后处理：一部分框被滤掉，其余沿用缓存的方向与文字
+        OcrLite &ocrLite = *engines[0];
+        ocrLite.setRefilterCache((int) pages.size());
+        for (size_t p = 0; p < pages.size(); ++p) {
+            double start = benchNowMs();
+            ocrLite.detectLayout(pages[p], layoutScoreThresh, (int) p);
+            double layoutEnd = benchNowMs();
+            ocrLite.refilterLayout((int) p, layoutScoreThresh + 0.1f);
+            double refilterEnd = benchNowMs();
+            ocrLite.detect(pages[p], padding, 0, boxScoreThresh, boxThresh, unClipRatio, true, true,
+                           (int) p);
+            double ocrEnd = benchNowMs();
+            ocrLite.refilter((int) p, boxScoreThresh + 0.1f, boxThresh + 0.1f, unClipRatio, true, true);
+            double end = benchNowMs();
+            samples["layout_detect"].push_back(layoutEnd - start);
+            samples["layout_refilter"].push_back(refilterEnd - layoutEnd);
+            samples["ocr_detect"].push_back(ocrEnd - refilterEnd);
+            samples["ocr_refilter"].push_back(end - ocrEnd);
+        }
+        ocrLite.setRefilterCache(0);
+    }
+
+    std::string json = "{\n";
+    json += "  \"pages\": " + std::to_string(pages.size()) + ",\n";
+    json += "  \"warmup\": " + std::to_string(warmup) + ",\n";
+    json += "  \"iterations\": " + std::to_string(iterations) + ",\n";
+    json += "  \"numThread\": " + std::to_string(numThread) + ",\n";
+    json += "  \"regionOcr\": " + std::string(regionOcr ? "true" : "false") + ",\n";
+    json += "  \"instances\": " + std::to_string(instances) + ",\n";
+    json += "  \"sharedArena\": " + std::string(sharedArena ? "true" : "false") + ",\n";
+    json += "  \"batch\": " + std::to_string(batch) + ",\n";
+    json += "  \"init_rss_mb\": " + std::to_string((rssAfterInit - rssBefore) / 1048576.0) + ",\n";
+    json += "  \"run_rss_mb\": " + std::to_string((rssAfterRun - rssBefore) / 1048576.0) + ",\n";
+    json += "  \"wall_ms\": " + std::to_string(wallMs) + ",\n";
+    json += "  \"stages\": {\n";
+    for (size_t i = 0; i < sizeof(STAGE_NAMES) / sizeof(STAGE_NAMES[0]); ++i) {
+        const std::vector<double> &stageSamples = samples[STAGE_NAMES[i]];
+        double stageTotal = 0.0;
+        for (double v : stageSamples) stageTotal += v;
+        json += "    \"" + std::string(STAGE_NAMES[i]) + "\": " +
+                statsToJson(benchComputeStats(stageSamples), stageTotal);
+        json += i + 1 < sizeof(STAGE_NAMES) / sizeof(STAGE_NAMES[0]) ? ",\n" : "\n";
+    }
+    json += "  }";
+    if (!layoutFastName.empty()) {
+        // count即各级产生的页数
+        json += ",\n  \"cascade\": {\n";
+        for (int i = 1; i < 3; ++i) {
+            const std::vector<double> &stageSamples = samples[CASCADE_NAMES[i]];
+            double stageTotal = 0.0;
+            for (double v : stageSamples) stageTotal += v;
+            json += "    \"" + std::string(CASCADE_NAMES[i]) + "\": " +
+                    statsToJson(benchComputeStats(stageSamples), stageTotal);
+            json += i < 2 ? ",\n" : "\n";
+        }
+        json += "  }";
+    }
+    if (refilter) {
+        json += ",\n  \"refilter\": {\n";
+        for (int i = 0; i < 4; ++i) {
+            const std::vector<double> &stageSamples = samples[REFILTER_NAMES[i]];
+            double stageTotal = 0.0;
+            for (double v : stageSamples) stageTotal += v;
+            json += "    \"" + std::string(REFILTER_NAMES[i]) + "\": " +
+                    statsToJson(benchComputeStats(stageSamples), stageTotal);
+            json += i < 3 ? ",\n" : "\n";
+        }
+        json += "  }";
+    }
+    json += "\n}\n";
+
+    if (jsonPath.empty()) {
+        fputs(json.c_str(), stdout);
+    } else {
+        FILE *fp = fopen(jsonPath.c_str(), "w");
+        if (fp == NULL) {
+            LOGE("cannot write %s", jsonPath.c_str());
+            return 1;
+        }
+        fputs(json.c_str(), fp);
+        fclose(fp);
+    }
+    return 0;
+}
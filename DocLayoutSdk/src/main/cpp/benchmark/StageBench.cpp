@@ -0,0 +1,309 @@
+// 非推理阶段微基准：全部使用合成输入，不需要模型文件
+#include <getopt.h>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include "BenchUtils.h"
+#include "OcrUtils.h"
+#include "NormalizeKernels.h"
+#include "DbNet.h"
+#include "CrnnNet.h"
+#include "Vocabulary.h"
+#include "LayoutNet.h"
+
+static volatile double benchSink = 0.0;
+
+// 白底页面上按网格排布 numBoxes 个"文本行"
+static std::vector<cv::Rect> makeGridRects(int width, int height, int numBoxes) {
+    int cols = (std::max)(1, (int) std::ceil(std::sqrt(numBoxes / 5.0)));
+    int rows = (numBoxes + cols - 1) / cols;
+    int cellW = width / cols;
+    int cellH = height / rows;
+    std::vector<cv::Rect> rects;
+    for (int i = 0; i < numBoxes; ++i) {
+        int c = i % cols;
+        int r = i / cols;
+        int w = (std::max)(4, cellW * 8 / 10);
+        int h = (std::max)(3, cellH * 6 / 10);
+        rects.emplace_back(c * cellW + (cellW - w) / 2, r * cellH + (cellH - h) / 2, w, h);
+    }
+    return rects;
+}
+
+static cv::Mat makePage(int width, int height, int numBoxes) {
+    cv::Mat page(height, width, CV_8UC3, cv::Scalar(255, 255, 255));
+    for (const auto &rect : makeGridRects(width, height, numBoxes)) {
+        cv::rectangle(page, rect, cv::Scalar(30, 30, 30), -1);
+    }
+    return page;
+}
+
+static std::vector<cv::Point> rectToBox(const cv::Rect &rect) {
+    return {cv::Point(rect.x, rect.y), cv::Point(rect.x + rect.width, rect.y),
+            cv::Point(rect.x + rect.width, rect.y + rect.height),
+            cv::Point(rect.x, rect.y + rect.height)};
+}
+
+class StageBench {
+public:
+    StageBench(std::string filter, double minTimeMs) : filter(std::move(filter)),
+                                                       minTimeMs(minTimeMs) {}
+
+    int run() {
+        printf("%-44s %7s %10s %10s %10s %10s\n", "stage", "iters", "mean(ms)", "p50(ms)",
+               "min(ms)", "max(ms)");
+        benchLayoutPreprocess();
+        benchLayoutParseNms();
+        benchNormalize();
+        benchDbNetPostprocess();
+        benchRotateCrop();
+        benchScoreToTextLine();
+        benchLayoutMarkdown();
+        return 0;
+    }
+
+private:
+    std::string filter;
+    double minTimeMs;
+    std::mt19937 rng{20240101u};
+    LayoutNet layoutNet;
+    CrnnNet crnnNet;
+
+    void report(const std::string &name, const std::function<void()> &fn, int minIters = 5) {
+        if (!filter.empty() && name.find(filter) == std::string::npos) return;
+        BenchStats stats = benchComputeStats(benchRun(fn, 1, minIters, 10000, minTimeMs));
+        printf("%-44s %7d %10.3f %10.3f %10.3f %10.3f\n", name.c_str(), stats.count, stats.mean,
+               stats.p50, stats.min, stats.max);
+        fflush(stdout);
+    }
+
+    void benchLayoutPreprocess() {
+        const int sizes[][2] = {{1240, 1754}, {3000, 4000}};
+        std::vector<float> input(3 * LayoutNet::INPUT_HEIGHT * LayoutNet::INPUT_WIDTH);
+        for (auto &size : sizes) {
+            cv::Mat page = makePage(size[0], size[1], 500);
+            for (int tier : LayoutNet::INPUT_TIERS) {
+                LayoutNet::Letterbox letterbox = LayoutNet::computeLetterbox(page.size(),
+                                                                             cv::Size(tier, tier));
+                report("LayoutNet::preprocessImage " + std::to_string(size[0]) + "x" +
+                       std::to_string(size[1]) + "@" + std::to_string(tier), [&]() {
+                    layoutNet.preprocessImage(page, letterbox, input.data());
+                    benchSink += input[0];
+                });
+            }
+            LayoutNet::Letterbox rect = LayoutNet::computeLetterbox(
+                    page.size(), cv::Size(LayoutNet::INPUT_WIDTH, LayoutNet::INPUT_HEIGHT), true);
+            report("LayoutNet::preprocessImage " + std::to_string(size[0]) + "x" +
+                   std::to_string(size[1]) + "@rect" + std::to_string(rect.inputSize.width) + "x" +
+                   std::to_string(rect.inputSize.height), [&]() {
+                layoutNet.preprocessImage(page, rect, input.data());
+                benchSink += input[0];
+            });
+            report("LayoutNet::selectInputSize " + std::to_string(size[0]) + "x" +
+                   std::to_string(size[1]), [&]() {
+                benchSink += layoutNet.selectInputSize(page);
+            });
+        }
+    }
+
+    // 合成 [1, N, 6] 输出：多数框在几个簇内互相重叠，用来压 NMS
+    std::vector<float> makeYoloOutput(int numDetections) {
+        std::uniform_real_distribution<float> pos(0.f, 960.f);
+        std::uniform_real_distribution<float> jitter(-12.f, 12.f);
+        std::uniform_real_distribution<float> ext(20.f, 300.f);
+        std::uniform_real_distribution<float> conf(0.f, 1.f);
+        std::uniform_int_distribution<int> cls(0, 9);
+        std::vector<float> output(numDetections * 6);
+        float cx = 0, cy = 0, w = 0, h = 0;
+        for (int i = 0; i < numDetections; ++i) {
+            if (i % 8 == 0) {
+                cx = pos(rng);
+                cy = pos(rng);
+                w = ext(rng);
+                h = ext(rng) / 4;
+            }
+            float x1 = cx + jitter(rng), y1 = cy + jitter(rng);
+            output[i * 6 + 0] = x1;
+            output[i * 6 + 1] = y1;
+            output[i * 6 + 2] = x1 + w + jitter(rng);
+            output[i * 6 + 3] = y1 + h + jitter(rng);
+            output[i * 6 + 4] = conf(rng);
+            output[i * 6 + 5] = (float) cls(rng);
+        }
+        return output;
+    }
+
+    void benchLayoutParseNms() {
+        cv::Mat page(4000, 3000, CV_8UC3);
+        LayoutNet::Letterbox letterbox = LayoutNet::computeLetterbox(
+                page.size(), cv::Size(LayoutNet::INPUT_WIDTH, LayoutNet::INPUT_HEIGHT));
+        for (int numDetections : {50, 300, 2000}) {
+            std::vector<float> output = makeYoloOutput(numDetections);
+            std::vector<int64_t> shape = {1, numDetections, 6};
+            report("parseYOLOv8Output+nmsBoxes n=" + std::to_string(numDetections), [&]() {
+                std::vector<LayoutBox> boxes = layoutNet.parseYOLOv8Output(output.data(), shape,
+                                                                           page, letterbox, 0.1f);
+                boxes = layoutNet.nmsBoxes(boxes, 0.4f);
+                benchSink += boxes.size();
+            });
+        }
+    }
+
+    void benchNormalize() {
+        const float meanValues[3] = {0.485 * 255, 0.456 * 255, 0.406 * 255};
+        const float normValues[3] = {1.0 / 0.229 / 255.0, 1.0 / 0.224 / 255.0,
+                                     1.0 / 0.225 / 255.0};
+        // 整页（DbNet）与文本行（AngleNet/CrnnNet）尺寸，每个可用内核各跑一遍并与标量实现比对
+        const int sizes[][2] = {{1024, 1024}, {3000, 4000}, {192, 48}, {320, 48}};
+        std::uniform_int_distribution<int> pixel(0, 255);
+        for (auto &size : sizes) {
+            cv::Mat img(size[1], size[0], CV_8UC3);
+            for (size_t i = 0; i < img.total() * 3; ++i) img.data[i] = (unsigned char) pixel(rng);
+            std::vector<float> reference(img.total() * 3);
+            std::vector<float> tensor(img.total() * 3);
+            const NormalizeKernel &scalar = getNormalizeKernels().front();
+            substractMeanNormalize(img, meanValues, normValues, reference.data(), &scalar);
+            for (const NormalizeKernel &kernel : getNormalizeKernels()) {
+                substractMeanNormalize(img, meanValues, normValues, tensor.data(), &kernel);
+                float maxDiff = 0.f;
+                for (size_t i = 0; i < tensor.size(); ++i) {
+                    maxDiff = (std::max)(maxDiff, std::fabs(tensor[i] - reference[i]));
+                }
+                if (maxDiff > 1e-5f) {
+                    fprintf(stderr, "substractMeanNormalize %s mismatch: max diff %g\n",
+                            kernel.name, maxDiff);
+                }
+                report("substractMeanNormalize[" + std::string(kernel.name) + "] " +
+                       std::to_string(size[0]) + "x" + std::to_string(size[1]), [&]() {
+                    substractMeanNormalize(img, meanValues, normValues, tensor.data(), &kernel);
+                    benchSink += tensor[0];
+                });
+            }
+        }
+    }
+
+    void benchDbNetPostprocess() {
+        const int side = 1024;
+        for (int numBoxes : {50, 500, 2000}) {
+            cv::Mat predMat(side, side, CV_32F, cv::Scalar(0.02));
+            for (const auto &rect : makeGridRects(side, side, numBoxes)) {
+                cv::rectangle(predMat, rect, cv::Scalar(0.9), -1);
+            }
+            cv::Mat cBufMat;
+            predMat.convertTo(cBufMat, CV_8UC1, 255);
+            ScaleParam s{side, side, side, side, 1.f, 1.f};
+            std::string suffix = " n=" + std::to_string(numBoxes);
+
+            report("findRsBoxes(threshold+dilate+contours)" + suffix, [&]() {
+                cv::Mat thresholdMat, dilateMat;
+                cv::threshold(cBufMat, thresholdMat, 0.3 * 255, 255, cv::THRESH_BINARY);
+                cv::Mat dilateElement = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(2, 2));
+                cv::dilate(thresholdMat, dilateMat, dilateElement);
+                std::vector<TextBox> boxes = findRsBoxes(predMat, dilateMat, s, 0.5f, 1.6f);
+                benchSink += boxes.size();
+            });
+
+            std::vector<std::vector<cv::Point2f>> minBoxes;
+            for (const auto &rect : makeGridRects(side, side, numBoxes)) {
+                minBoxes.push_back({cv::Point2f(rect.x, rect.y),
+                                    cv::Point2f(rect.x + rect.width, rect.y),
+                                    cv::Point2f(rect.x + rect.width, rect.y + rect.height),
+                                    cv::Point2f(rect.x, rect.y + rect.height)});
+            }
+            report("boxScoreFast" + suffix, [&]() {
+                for (const auto &box : minBoxes) benchSink += boxScoreFast(box, predMat);
+            });
+            report("unClip" + suffix, [&]() {
+                for (const auto &box : minBoxes) benchSink += unClip(box, 1.6f).size.width;
+            });
+        }
+    }
+
+    void benchRotateCrop() {
+        // 每次调用都会复制整页，2000 框时单次迭代就是数十 GB 内存拷贝，这里取 50/500
+        for (int numBoxes : {50, 500}) {
+            cv::Mat page = makePage(3000, 4000, numBoxes);
+            std::vector<std::vector<cv::Point>> boxes;
+            for (const auto &rect : makeGridRects(3000, 4000, numBoxes)) {
+                boxes.push_back(rectToBox(rect));
+            }
+            report("getRotateCropImage 3000x4000 n=" + std::to_string(numBoxes), [&]() {
+                for (const auto &box : boxes) {
+                    cv::Mat part = getRotateCropImage(page, box);
+                    benchSink += part.cols;
+                }
+            }, 1);
+        }
+    }
+
+    void benchScoreToTextLine() {
+        const int numKeys = 6623;
+        std::string keysText;
+        for (int i = 0; i < numKeys; ++i) keysText.append("\xe5\xad\x97\n");
+        report("Vocabulary::parseText n=" + std::to_string(numKeys), [&]() {
+            Vocabulary vocabulary;
+            vocabulary.parseText(keysText.data(), keysText.size());
+            benchSink += vocabulary.size();
+        });
+        crnnNet.vocabulary.parseText(keysText.data(), keysText.size());
+        const int w = (int) crnnNet.vocabulary.size();
+
+        std::uniform_real_distribution<float> noise(0.f, 0.01f);
+        std::uniform_int_distribution<int> peak(0, w - 1);
+        for (int h : {40, 160}) {
+            std::vector<float> outputData(h * w);
+            for (auto &v : outputData) v = noise(rng);
+            for (int i = 0; i < h; ++i) outputData[i * w + peak(rng)] = 0.95f;
+            report("CrnnNet::scoreToTextLine T=" + std::to_string(h) + " C=" + std::to_string(w),
+                   [&]() {
+                       TextLine line = crnnNet.scoreToTextLine(outputData.data(), h, w);
+                       benchSink += line.text.size();
+                   });
+        }
+    }
+
+    void benchLayoutMarkdown() {
+        cv::Mat page(4000, 3000, CV_8UC3);
+        LayoutNet::Letterbox letterbox = LayoutNet::computeLetterbox(
+                page.size(), cv::Size(LayoutNet::INPUT_WIDTH, LayoutNet::INPUT_HEIGHT));
+        for (int numBoxes : {50, 500, 2000}) {
+            std::vector<float> output = makeYoloOutput(numBoxes);
+            for (int i = 0; i < numBoxes; ++i) output[i * 6 + 4] = 0.9f;
+            std::vector<int64_t> shape = {1, numBoxes, 6};
+            LayoutResult layoutResult;
+            layoutResult.layoutNetTime = 0;
+            layoutResult.layoutBoxes = layoutNet.parseYOLOv8Output(output.data(), shape, page,
+                                                                      letterbox, 0.1f);
+            report("generateLayoutMarkdown n=" + std::to_string(numBoxes), [&]() {
+                std::string markdown = layoutNet.generateLayoutMarkdown(layoutResult);
+                benchSink += markdown.size();
+            });
+        }
+    }
+};
+
+int main(int argc, char **argv) {
+    std::string filter;
+    double minTimeMs = 500;
+    static const struct option longOptions[] = {
+            {"filter",  required_argument, NULL, 'f'},
+            {"minTime", required_argument, NULL, 'm'},
+            {"help",    no_argument,       NULL, 'h'},
+            {NULL,      no_argument,       NULL, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "f:m:h", longOptions, NULL)) != -1) {
+        switch (opt) {
+            case 'f': filter = optarg; break;
+            case 'm': minTimeMs = atof(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [--filter SUBSTR] [--minTime MS]\n", argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    return StageBench(filter, minTimeMs).run();
+}
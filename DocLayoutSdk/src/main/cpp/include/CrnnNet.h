@@ -2,11 +2,16 @@
 #define __OCR_CRNNNET_H__
 
 #include "OcrStruct.h"
+#include "TensorBinding.h"
+#include "ModelSource.h"
+#include "Vocabulary.h"
 #include "onnxruntime/core/session/onnxruntime_cxx_api.h"
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
+#ifdef __ANDROID__
 #include <android/asset_manager.h>
 #include <android/asset_manager_jni.h>
+#endif
 
 class CrnnNet {
 public:
@@ -17,28 +22,59 @@ public:
 
     void setNumThread(int numOfThread);
 
+    // 开启ORT算子级profiling，须在initModel之前调用；ORT在prefix后追加时间戳生成json
+    void setProfiling(const std::string &prefix);
+
+    // 结束profiling，返回profile文件路径
+    std::string endProfiling();
+
+    // 卸载session并解除模型映射，之后可再次initModel
+    void releaseModel();
+
+    // 模型文件字节数（权重主体），0表示未加载过
+    size_t getModelBytes() const { return modelBytes; }
+
+    // 最近一次initModel的分段耗时
+    const ModelLoadTiming &getLoadTiming() const { return loadTiming; }
+
+#ifdef __ANDROID__
     void initModel(AAssetManager *mgr, const std::string &name, const std::string &keysName);
+#endif
+
+    void initModel(const std::string &path, const std::string &keysPath);
 
-    std::vector<TextLine> getTextLines(std::vector<cv::Mat> &partImg);
+    std::vector<TextLine> getTextLines(std::vector<cv::Mat> &partImg, NetTiming &timing);
 
 private:
-    Ort::Session *session;
-    Ort::Env ortEnv = Ort::Env(ORT_LOGGING_LEVEL_ERROR, "CrnnNet");
+    // 微基准测试直接调用预处理/后处理私有函数
+    friend class StageBench;
+
+    Ort::Session *session = nullptr;
     Ort::SessionOptions sessionOptions = Ort::SessionOptions();
     int numThread = 0;
+    bool profiling = false;
+    int runCount = 0;
 
-    std::vector<Ort::AllocatedStringPtr> inputNamesPtr;
-    std::vector<Ort::AllocatedStringPtr> outputNamesPtr;
+    TensorBinding binding;
+    // ORT格式模型时session直接引用这块映射，须与session同生命周期
+    ModelSource modelSource;
+    size_t modelBytes = 0;
+    ModelLoadTiming loadTiming;
+    SharedPrepackedWeights prepackedWeights;
 
     const float meanValues[3] = {127.5, 127.5, 127.5};
     const float normValues[3] = {1.0 / 127.5, 1.0 / 127.5, 1.0 / 127.5};
     const int dstHeight = 48;
 
-    std::vector<std::string> keys;
+    // CTC字表，下标即类别号
+    Vocabulary vocabulary;
+
+    // 文本行预处理复用的缓冲区
+    cv::Mat srcResize;
 
-    TextLine scoreToTextLine(const std::vector<float> &outputData, int h, int w);
+    TextLine scoreToTextLine(const float *outputData, int h, int w);
 
-    TextLine getTextLine(cv::Mat &src);
+    TextLine getTextLine(cv::Mat &src, NetTiming &timing);
 };
 
 
@@ -2,11 +2,21 @@
 #define __OCR_DBNET_H__
 
 #include "OcrStruct.h"
+#include "TensorBinding.h"
+#include "ModelSource.h"
 #include "onnxruntime/core/session/onnxruntime_cxx_api.h"
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
+#ifdef __ANDROID__
 #include <android/asset_manager.h>
 #include <android/asset_manager_jni.h>
+#endif
+
+// DbNet一次推理的原始输出，refilterTextBoxes换阈值时只重做二值化、轮廓与框评分
+struct DbNetRaw {
+    cv::Mat probMap;  // CV_32F概率图，尺寸为缩放后的输入
+    ScaleParam scale;
+};
 
 class DbNet {
 public:
@@ -16,23 +26,64 @@ public:
 
     void setNumThread(int numOfThread);
 
+    // 开启ORT算子级profiling，须在initModel之前调用；ORT在prefix后追加时间戳生成json
+    void setProfiling(const std::string &prefix);
+
+    // 结束profiling，返回profile文件路径
+    std::string endProfiling();
+
+    // 卸载session并解除模型映射，之后可再次initModel
+    void releaseModel();
+
+    // 模型文件字节数（权重主体），0表示未加载过
+    size_t getModelBytes() const { return modelBytes; }
+
+    // 最近一次initModel的分段耗时
+    const ModelLoadTiming &getLoadTiming() const { return loadTiming; }
+
+#ifdef __ANDROID__
     void initModel(AAssetManager *mgr, const std::string &name);
+#endif
+
+    void initModel(const std::string &path);
 
+    // raw非空时保存一份概率图，供refilterTextBoxes使用
     std::vector<TextBox> getTextBoxes(cv::Mat &src, ScaleParam &s, float boxScoreThresh,
-                                      float boxThresh, float unClipRatio);
+                                      float boxThresh, float unClipRatio, NetTiming &timing,
+                                      DbNetRaw *raw = nullptr);
+
+    // 用保存的概率图按新阈值重新取框，不需要session
+    std::vector<TextBox> refilterTextBoxes(DbNetRaw &raw, float boxScoreThresh, float boxThresh,
+                                           float unClipRatio, NetTiming &timing);
 
 private:
-    Ort::Session *session;
-    Ort::Env ortEnv = Ort::Env(ORT_LOGGING_LEVEL_ERROR, "DbNet");
+    Ort::Session *session = nullptr;
     Ort::SessionOptions sessionOptions = Ort::SessionOptions();
     int numThread = 0;
+    bool profiling = false;
+    int runCount = 0;
+
+    TensorBinding binding;
+    // ORT格式模型时session直接引用这块映射，须与session同生命周期
+    ModelSource modelSource;
+    size_t modelBytes = 0;
+    ModelLoadTiming loadTiming;
+    SharedPrepackedWeights prepackedWeights;
+    // 预处理/后处理中间图，页面尺寸不变时复用内存
+    cv::Mat srcResize;
+    cv::Mat cBufMat;
+    cv::Mat thresholdMat;
+    cv::Mat dilateMat;
 
-    std::vector<Ort::AllocatedStringPtr> inputNamesPtr;
-    std::vector<Ort::AllocatedStringPtr> outputNamesPtr;
+    // 概率图 -> 二值化、膨胀、取轮廓并评分
+    std::vector<TextBox> postprocess(const cv::Mat &predMat, ScaleParam &s, float boxScoreThresh,
+                                     float boxThresh, float unClipRatio);
 
     const float meanValues[3] = {0.485 * 255, 0.456 * 255, 0.406 * 255};
     const float normValues[3] = {1.0 / 0.229 / 255.0, 1.0 / 0.224 / 255.0, 1.0 / 0.225 / 255.0};
 };
 
+std::vector<TextBox> findRsBoxes(const cv::Mat &predMat, const cv::Mat &dilateMat, ScaleParam &s,
+                                 const float boxScoreThresh, const float unClipRatio);
 
 #endif //__OCR_DBNET_H__
@@ -2,15 +2,31 @@
 #define __OCR_LAYOUTNET_H__
 
 #include "OcrStruct.h"
+#include "TensorBinding.h"
+#include "ModelSource.h"
 #include "onnxruntime/core/session/onnxruntime_cxx_api.h"
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
+#ifdef __ANDROID__
 #include <android/asset_manager.h>
 #include <android/asset_manager_jni.h>
+#endif
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <atomic>
 #include <map>
+#include <memory>
+
+class StageTimer;
+
+// 两级版面分析的放行条件：快速模型的结果满足全部条件时直接采用，否则再跑完整模型
+struct LayoutCascadeConfig {
+    int fastInputSize = 640;      // 快速模型为动态输入时的边长，固定输入的模型用自身尺寸
+    float minMeanScore = 0.5f;    // 保留框的平均置信度下限
+    float minInkCoverage = 0.9f;  // 页面墨迹落在检测框内的比例下限，漏检的内容会拉低它
+    bool escalateComplex = true;  // 检测到图片/表格/公式时交给完整模型
+};
 
 class LayoutNet {
 public:
@@ -20,24 +36,171 @@ public:
 
     void setNumThread(int numOfThread);
 
+    // 开启ORT算子级profiling，须在initModel之前调用；ORT在prefix后追加时间戳生成json
+    void setProfiling(const std::string &prefix);
+
+    // 结束profiling，返回profile文件路径
+    std::string endProfiling();
+
+    // 卸载session并解除模型映射，之后可再次initModel
+    void releaseModel();
+
+    // 模型文件字节数（权重主体，含级联的快速模型），0表示未加载过
+    size_t getModelBytes() const { return modelBytes + (fastNet ? fastNet->modelBytes : 0); }
+
+    // 最近一次initModel的分段耗时
+    const ModelLoadTiming &getLoadTiming() const { return loadTiming; }
+
+#ifdef __ANDROID__
     void initModel(AAssetManager *mgr, const std::string &name);
+#endif
+
+    void initModel(const std::string &path);
+
+    // 开启两级级联，须在initModel之前调用：initModel时以同样的方式（文件或asset）再加载fastModel，
+    // 之后每页先由它分析，不满足config的放行条件才跑本模型。fastModel为空关闭级联
+    void setCascade(const std::string &fastModel,
+                    const LayoutCascadeConfig &config = LayoutCascadeConfig());
+
+    // 快速模型是否已加载
+    bool hasCascade() const { return fastNet && fastNet->session; }
+
+    // 可选的输入边长档位；自动模式从中选择
+    static const int INPUT_TIERS[3];
+
+    // getLayoutBoxesBatch每次Run的默认页数上限：1024²每页约12MB输入，8页约100MB
+    static const int DEFAULT_MAX_BATCH = 8;
+
+    // 输入边长，须是32的倍数，范围[320, 1024]；0为自动：按页面尺寸和内容密度从INPUT_TIERS里选。
+    // 只对导出为动态输入的模型生效，固定输入的模型始终用模型自身的尺寸。默认1024
+    void setInputSize(int size);
+
+    int getInputSize() const { return inputSize; }
+
+    // 模型输入的空间维度是否动态（initModel之后有效）
+    bool isDynamicInput() const { return dynamicInput; }
+
+    // 开启后输入不再补成正方形，只把短边补到32的倍数（如A4竖版1024×736），省掉灰边上的计算；
+    // 只对动态输入的模型生效。默认关闭，与best_demo_python_standard.py的默认行为一致（对应其--rect）
+    void setRectInput(bool enabled);
+
+    bool isRectInput() const { return rectInput; }
+
+    // 模型输入的batch维是否动态（initModel之后有效）；固定为1时批量接口逐页运行
+    bool isDynamicBatch() const { return dynamicBatch; }
+
+    // 可能用到的输入边长：自动模式下为全部档位，供预热
+    std::vector<int> getCandidateInputSizes() const;
 
-    LayoutResult getLayoutBoxes(cv::Mat &src, float boxScoreThresh = 0.2f);
+    // 一次letterbox的参数，预处理与还原坐标共用。
+    // rect模式下两侧padding之和是奇数时右/下比左/上多1，还原坐标只需减去左/上padding
+    struct Letterbox {
+        cv::Size inputSize; // 模型输入（宽, 高）
+        cv::Size newUnpad;  // resize后的图像尺寸
+        float gain;         // 缩放比例
+        int padLeft;
+        int padTop;
+    };
+
+    // 一次推理的原始输出，refilter换阈值时只重做解析、NMS与绘制
+    struct RawOutput {
+        cv::Mat src;                 // 引用原图，不复制；调用方不要原地修改
+        Letterbox letterbox;
+        std::vector<int64_t> shape;  // [1, det, 6]；推理失败时不写入，调用方可先清空再据此判断
+        std::vector<float> data;
+        LayoutStage stage = LayoutStage::Full;
+    };
+
+    // forcedInputSize>0时本次强制使用该边长（仍受模型是否动态输入限制）并跳过级联，否则按setInputSize的设置。
+    // raw非空时保存产生结果的那一级的原始输出
+    LayoutResult getLayoutBoxes(cv::Mat &src, float boxScoreThresh = 0.2f, int forcedInputSize = 0,
+                                RawOutput *raw = nullptr);
+
+    // 按新的置信度阈值重新解析保存的原始输出，不需要session
+    LayoutResult refilter(const RawOutput &raw, float boxScoreThresh);
+
+    // 多页一次推理：输入尺寸相同的页面拼成N×3×H×W，一次Run后把[N, det, 6]的输出拆回各页。
+    // 自动选档时按档位分组，rect模式下组内统一补到最大的宽高，每组再按maxBatch切分（<=0取DEFAULT_MAX_BATCH）。
+    // 超过单页大小的输入/输出缓冲区在返回前释放，不常驻。结果与pages一一对应，空页面返回空结果。
+    // 每页的inference耗时为整批的平均值。开启级联时快速模型先批量跑全部页面，未通过的页面再批量跑本模型
+    std::vector<LayoutResult> getLayoutBoxesBatch(std::vector<cv::Mat> &pages,
+                                                  float boxScoreThresh = 0.2f,
+                                                  int maxBatch = DEFAULT_MAX_BATCH);
 
     std::string generateMarkdown(const LayoutResult &layoutResult);
 
 private:
+    // 微基准测试直接调用预处理/后处理私有函数
+    friend class StageBench;
+
     Ort::Session *session;
-    Ort::Env ortEnv = Ort::Env(ORT_LOGGING_LEVEL_ERROR, "LayoutNet");
     Ort::SessionOptions sessionOptions = Ort::SessionOptions();
     int numThread = 0;
+    bool profiling = false;
+    int runCount = 0;
 
-    std::vector<Ort::AllocatedStringPtr> inputNamesPtr;
-    std::vector<Ort::AllocatedStringPtr> outputNamesPtr;
+    TensorBinding binding;
+    // ORT格式模型时session直接引用这块映射，须与session同生命周期
+    ModelSource modelSource;
+    size_t modelBytes = 0;
+    ModelLoadTiming loadTiming;
+    SharedPrepackedWeights prepackedWeights;
+    // 级联的快速模型及其放行条件
+    std::string cascadeModel;
+    LayoutCascadeConfig cascadeConfig;
+    std::unique_ptr<LayoutNet> fastNet;
+    // 级联中的快速模型不绘制也不生成Markdown，结果被采用时由外层补上
+    bool renderEnabled = true;
+    // 优化缓存文件名与profiling的前缀；快速模型用自己的名字，两个模型的缓存才不会互相当作过期文件删掉
+    const char *netName = "LayoutNet";
+    // letterbox前的resize结果，跨调用复用
+    cv::Mat resizeMat;
 
-    // DOCLAYOUT_DOCSTRUCTBENCH 模型配置
+    // DOCLAYOUT_DOCSTRUCTBENCH 模型导出时的输入尺寸
     static const int INPUT_WIDTH = 1024;
     static const int INPUT_HEIGHT = 1024;
+    static const int MIN_INPUT_SIZE = 320;
+    static const int INPUT_STRIDE = 32;
+
+    // 可能在推理线程之外修改
+    std::atomic<int> inputSize{INPUT_WIDTH};
+    std::atomic<bool> rectInput{false};
+    bool dynamicInput = false;
+    bool dynamicBatch = false;
+    // 固定输入的模型从模型读出的尺寸
+    cv::Size modelInputSize = cv::Size(INPUT_WIDTH, INPUT_HEIGHT);
+
+    // 按targetSize等比缩放；rect为true时输入的宽高各自只补到INPUT_STRIDE的倍数，否则补满targetSize
+    static Letterbox computeLetterbox(const cv::Size &srcSize, const cv::Size &targetSize,
+                                      bool rect = false);
+
+    // 按inputSize与newUnpad居中padding
+    static void centerPadding(Letterbox &letterbox);
+
+    // 读模型输入形状，判断是否动态输入
+    void readInputShape();
+
+    // 本次缩放的目标尺寸（正方形档位，或固定输入模型的尺寸）
+    cv::Size resolveInputSize(const cv::Mat &src, int forcedSize) const;
+
+    // 自动模式：按页面尺寸和内容密度选档位
+    int selectInputSize(const cv::Mat &src) const;
+
+    // initModel之后创建并加载快速模型
+    LayoutNet *createFastNet();
+
+    // 快速模型的结果是否满足放行条件
+    bool acceptFastResult(const cv::Mat &src, const LayoutResult &fast) const;
+
+    // 页面墨迹（缩略图上的深色像素）落在boxes内的比例，没有墨迹时为1
+    static float inkCoverage(const cv::Mat &src, const std::vector<LayoutBox> &boxes);
+
+    // 单个模型的单页/多页分析，不经过级联
+    LayoutResult runLayout(cv::Mat &src, float boxScoreThresh, int forcedInputSize,
+                           RawOutput *raw = nullptr);
+
+    std::vector<LayoutResult> runLayoutPages(std::vector<cv::Mat> &pages, float boxScoreThresh,
+                                             int maxBatch);
 
     // DOCLAYOUT_DOCSTRUCTBENCH 支持的10个类别
     std::vector<std::string> getLayoutClassNames();
@@ -48,19 +211,42 @@ private:
     // 将整数转换为LayoutType
     LayoutType intToLayoutType(int classId);
 
-    // 预处理图像 - YOLOv8风格
-    cv::Mat preprocessImage(const cv::Mat &src);
+    // 预处理图像 - YOLOv8风格letterbox，输出RGB CHW float到dst（3*输入高*输入宽）
+    void preprocessImage(const cv::Mat &src, const Letterbox &letterbox, float *dst);
 
-    // 解析YOLOv8格式输出
-    std::vector<LayoutBox> parseYOLOv8Output(float* outputData,
+    // 解析YOLOv8格式输出，按letterbox把坐标还原到src
+    std::vector<LayoutBox> parseYOLOv8Output(const float* outputData,
                                             const std::vector<int64_t>& outputShape,
                                             const cv::Mat& src,
+                                            const Letterbox &letterbox,
                                             float confThreshold);
 
-    // 计算IoU
-    float calculateIoU(const LayoutBox &box1, const LayoutBox &box2);
+    // 一批输入尺寸相同的页面：预处理进同一个输入张量，推理一次后逐页解析
+    void runLayoutBatch(std::vector<cv::Mat> &pages, const std::vector<size_t> &indices,
+                        std::vector<Letterbox> &letterboxes, float boxScoreThresh,
+                        std::vector<LayoutResult> &results);
+
+    // 解析单页输出（outputShape为[1, det, 6]），完成NMS、Markdown与绘制，各阶段耗时计入result
+    void decodeLayoutResult(cv::Mat &src, const float *outputData,
+                            const std::vector<int64_t> &outputShape, const Letterbox &letterbox,
+                            float boxScoreThresh, StageTimer &timer, LayoutResult &result);
+
+    // 生成Markdown并绘制检测结果
+    void renderLayoutResult(cv::Mat &src, StageTimer &timer, LayoutResult &result);
+
+    // NMS用的框缓冲区（structure-of-arrays），跨调用复用，稳态下不再分配
+    struct NmsBuffer {
+        std::vector<float> x1, y1, x2, y2, area, score;
+        std::vector<int> classId;
+        std::vector<int> order; // 类别升序、同类分数降序
+        std::vector<int> keep;  // 保留框的下标，顺序同order
+    };
+    NmsBuffer nmsBuffer;
+
+    // 按类别的贪心NMS：一次排序后每个类别是order里连续的一段，候选框只与本类已保留的框比较
+    static void nmsIndices(NmsBuffer &buffer, float iouThreshold);
 
-    // NMS过滤重叠框
+    // NMS过滤重叠框，保留的框从boxes里移出
     std::vector<LayoutBox> nmsBoxes(std::vector<LayoutBox> &boxes, float iouThreshold = 0.4f);
 
     // 根据版面分析结果生成Markdown
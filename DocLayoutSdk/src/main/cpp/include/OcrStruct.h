@@ -42,6 +42,56 @@ struct TextBlock {
     double blockTime;
 };
 
+// 单个阶段的耗时(ms)：墙钟时间 + 调用线程的CPU时间
+// cpuTime只统计调用线程，ORT线程池里的计算不计入，因此推理阶段cpuTime远小于wallTime属正常
+struct StageTiming {
+    double wallTime = 0;
+    double cpuTime = 0;
+
+    StageTiming &operator+=(const StageTiming &other) {
+        wallTime += other.wallTime;
+        cpuTime += other.cpuTime;
+        return *this;
+    }
+};
+
+// 单个网络各阶段的耗时，同一网络多次调用（如每个文本框一次CrnnNet）时累加
+struct NetTiming {
+    StageTiming preprocess;   // resize/归一化/建张量
+    StageTiming inference;    // session->Run
+    StageTiming postprocess;  // 输出解码
+    StageTiming nms;          // 仅LayoutNet
+    StageTiming crop;         // DbNet: 文本框透视裁剪; LayoutNet: 区域OCR前的版面区域裁剪
+    StageTiming render;       // 画框、生成Markdown
+
+    NetTiming &operator+=(const NetTiming &other) {
+        preprocess += other.preprocess;
+        inference += other.inference;
+        postprocess += other.postprocess;
+        nms += other.nms;
+        crop += other.crop;
+        render += other.render;
+        return *this;
+    }
+};
+
+struct PipelineTiming {
+    NetTiming dbNet;
+    NetTiming angleNet;
+    NetTiming crnnNet;
+    NetTiming layoutNet;
+    StageTiming jniMarshal;   // Bitmap<->Mat转换与结果对象构造，仅JNI调用时有值
+
+    PipelineTiming &operator+=(const PipelineTiming &other) {
+        dbNet += other.dbNet;
+        angleNet += other.angleNet;
+        crnnNet += other.crnnNet;
+        layoutNet += other.layoutNet;
+        jniMarshal += other.jniMarshal;
+        return *this;
+    }
+};
+
 // DOCLAYOUT_DOCSTRUCTBENCH 支持的10个类别
 enum class LayoutType {
     TITLE = 0,              // 0: title
@@ -66,11 +116,21 @@ struct LayoutBox {
     bool hasOcrText;      // 是否包含OCR文本
 };
 
+// 版面结果由级联的哪一级产生
+enum class LayoutStage {
+    Full = 0,      // 未开启级联，完整模型
+    Fast = 1,      // 快速模型的结果通过了放行条件
+    Escalated = 2  // 快速模型未通过，改用完整模型；耗时含两级
+};
+
 struct LayoutResult {
     double layoutNetTime;
+    cv::Size inputSize;     // LayoutNet本次的输入尺寸（宽, 高），为产生结果的那一级
+    LayoutStage stage = LayoutStage::Full;
     std::vector<LayoutBox> layoutBoxes;
     cv::Mat layoutImg;
     std::string markdown;
+    PipelineTiming timing;
 };
 
 struct OcrResult {
@@ -79,6 +139,7 @@ struct OcrResult {
     cv::Mat boxImg;
     double detectTime;
     std::string strRes;
+    PipelineTiming timing;
 };
 
 #endif //__OCR_STRUCT_H__
@@ -0,0 +1,50 @@
+#ifndef __OCR_TENSOR_BINDING_H__
+#define __OCR_TENSOR_BINDING_H__
+
+#include "onnxruntime/core/session/onnxruntime_cxx_api.h"
+#include <map>
+#include <memory>
+#include <vector>
+
+// 每个网络一份的输入/输出缓冲区，通过IoBinding绑定到session
+// 缓冲区只增不减（trimBuffers除外）；某个输入形状第一次Run后记住其输出形状，之后输出直接写进预分配缓冲区，
+// 稳态下Run不再为张量数据分配堆内存。只绑定第一个输入和第一个输出（四个网络都只用这一对）
+class TensorBinding {
+public:
+    // initModel创建session后调用，缓存输入/输出名
+    void init(Ort::Session *session);
+
+    void reset();
+
+    // 返回能容纳shape的输入缓冲区，调用方写入NCHW数据后调用run
+    float *inputBuffer(const std::vector<int64_t> &shape);
+
+    // 返回的指针在下一次inputBuffer/run之前有效
+    const float *run(const Ort::RunOptions &runOptions, std::vector<int64_t> &outputShape);
+
+    // 输入缓冲区超过maxInputCount个元素时释放输入/输出缓冲区，下次按需重新分配；
+    // 用于偶尔的大batch之后归还内存。之前run返回的指针随之失效
+    void trimBuffers(size_t maxInputCount);
+
+    const char *inputName() const;
+
+    const char *outputName() const;
+
+private:
+    Ort::Session *session = nullptr;
+    std::unique_ptr<Ort::IoBinding> binding;
+    Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+
+    std::vector<Ort::AllocatedStringPtr> inputNamesPtr;
+    std::vector<Ort::AllocatedStringPtr> outputNamesPtr;
+
+    std::vector<float> inputData;
+    std::vector<int64_t> inputShape;
+    std::vector<float> outputData;
+    // 形状未知时由ORT分配的输出，保留到下一次run
+    std::vector<Ort::Value> ortOutputs;
+    // 输入形状 -> 输出形状，空表示输出形状不固定；CrnnNet按宽度变化，超过上限时清空
+    std::map<std::vector<int64_t>, std::vector<int64_t>> outputShapes;
+};
+
+#endif //__OCR_TENSOR_BINDING_H__
@@ -0,0 +1,44 @@
+#ifndef __OCR_VOCABULARY_H__
+#define __OCR_VOCABULARY_H__
+
+#include "ModelSource.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// CTC解码用的字表：全部字符的UTF-8字节连续存放，第i个字符为 bytes[offsets[i], offsets[i+1])，
+// 下标即模型输出的类别号（0为blank，最后一个为空格），不为每个字符单独分配std::string。
+// 编译字表（scripts/compile_vocab.py 生成）的布局，小端：
+//   "OCRV" | uint32 版本(1) | uint32 字符数n | uint32 offsets[n+1] | UTF-8字节
+class Vocabulary {
+public:
+    // 编译字表直接引用source的映射（source随之移入）；
+    // 否则按文本字表（每行一个字符）解析，首尾补上blank("#")和空格
+    bool load(ModelSource &&source);
+
+    // 解析内存中的文本字表，规则同load
+    void parseText(const char *text, size_t length);
+
+    void clear();
+
+    size_t size() const { return count; }
+
+    // 是否直接使用映射的编译字表
+    bool isCompiled() const { return source.data() != nullptr; }
+
+    void append(std::string &dst, size_t index) const {
+        dst.append(bytes + offsets[index], offsets[index + 1] - offsets[index]);
+    }
+
+private:
+    ModelSource source;
+    std::vector<uint32_t> ownedOffsets;
+    std::string ownedBytes;
+    const uint32_t *offsets = nullptr;
+    const char *bytes = nullptr;
+    size_t count = 0;
+
+    bool loadCompiled();
+};
+
+#endif //__OCR_VOCABULARY_H__
@@ -1,88 +1,109 @@
 #include "CrnnNet.h"
 #include "OcrUtils.h"
+#include "ModelSource.h"
+#include "OcrTrace.h"
 #include <numeric>
 
 CrnnNet::CrnnNet() {}
 
 CrnnNet::~CrnnNet() {
+    binding.reset();
     delete session;
-    inputNamesPtr.clear();
-    outputNamesPtr.clear();
 }
 
 void CrnnNet::setNumThread(int numOfThread) {
     numThread = numOfThread;
     //===session options===
-    // Sets the number of threads used to parallelize the execution within nodes
-    // A value of 0 means ORT will pick a default
-    sessionOptions.SetIntraOpNumThreads(numThread);
-    //set OMP_NUM_THREADS=16
-
-    // Sets the number of threads used to parallelize the execution of the graph (across nodes)
-    // If sequential execution is enabled this value is ignored
-    // A value of 0 means ORT will pick a default
-    sessionOptions.SetInterOpNumThreads(numThread);
-
-    // Sets graph optimization level
-    // ORT_DISABLE_ALL -> To disable all optimizations
-    // ORT_ENABLE_BASIC -> To enable basic optimizations (Such as redundant node removals)
-    // ORT_ENABLE_EXTENDED -> To enable extended optimizations (Includes level 1 + more complex optimizations like node fusions)
-    // ORT_ENABLE_ALL -> To Enable All possible opitmizations
-    sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+    // 不再为每个session单独建intra/inter线程池，统一使用getOrtEnv()的全局线程池，
+    // 池大小即OcrLite的线程预算
+    setOrtThreadBudget(numThread);
+    sessionOptions.DisablePerSessionThreads();
 }
 
-char *readKeysFromAssets(AAssetManager *mgr, const std::string &keysName) {
-    //LOGI("readKeysFromAssets start...");
-    if (mgr == NULL) {
-        LOGE(" %s", "AAssetManager==NULL");
-        return NULL;
+void CrnnNet::setProfiling(const std::string &prefix) {
+    profiling = !prefix.empty();
+    if (profiling) {
+        sessionOptions.EnableProfiling(prefix.c_str());
+    } else {
+        sessionOptions.DisableProfiling();
     }
-    char *buffer;
-    /*获取文件名并打开*/
-    AAsset *asset = AAssetManager_open(mgr, keysName.c_str(), AASSET_MODE_UNKNOWN);
-    if (asset == NULL) {
-        LOGE(" %s", "asset==NULL");
-        return NULL;
+}
+
+std::string CrnnNet::endProfiling() {
+    return endSessionProfiling(session, profiling);
+}
+
+void CrnnNet::releaseModel() {
+    binding.reset();
+    delete session;
+    session = nullptr;
+    prepackedWeights.reset();
+    modelSource.release();
+}
+
+// 编译字表（.vocab）不存在或校验失败时退回同名的文本字表（.txt）
+static std::string getTextKeysName(const std::string &name) {
+    const std::string ext = ".vocab";
+    if (name.size() <= ext.size() || name.compare(name.size() - ext.size(), ext.size(), ext) != 0) {
+        return "";
     }
-    /*获取文件大小*/
-    off_t bufferSize = AAsset_getLength(asset);
-    //LOGI("file size : %d", bufferSize);
-    buffer = (char *) malloc(bufferSize + 1);
-    buffer[bufferSize] = 0;
-    int numBytesRead = AAsset_read(asset, buffer, bufferSize);
-    //LOGI("readKeysFromAssets: %d", numBytesRead);
-    /*关闭文件*/
-    AAsset_close(asset);
-    //LOGI("readKeysFromAssets exit...");
-    return buffer;
+    return name.substr(0, name.size() - ext.size()) + ".txt";
 }
 
+#ifdef __ANDROID__
 void CrnnNet::initModel(AAssetManager *mgr, const std::string &name, const std::string &keysName) {
-    int dbModelDataLength = 0;
-    void *dbModelData = getModelDataFromAssets(mgr, name.c_str(), dbModelDataLength);
-    session = new Ort::Session(ortEnv, dbModelData, dbModelDataLength,
-                               sessionOptions);
-    free(dbModelData);
-    inputNamesPtr = getInputNames(session);
-    outputNamesPtr = getOutputNames(session);
+    double readStartTime = getCurrentTime();
+    modelSource.openAsset(mgr, name);
+    modelBytes = modelSource.size();
+    loadTiming.readMs = getCurrentTime() - readStartTime;
+    prepackedWeights = getSharedPrepackedWeights(name);
+    session = createSession(getOrtEnv(), modelSource, sessionOptions, "CrnnNet",
+                            GraphOptimizationLevel::ORT_ENABLE_EXTENDED, &loadTiming,
+                            prepackedWeights.get());
+    binding.init(session);
 
     //load keys
-    char *buffer = readKeysFromAssets(mgr, keysName);
-    if (buffer != NULL) {
-        std::istringstream inStr(buffer);
-        std::string line;
-        while (getline(inStr, line)) {
-            keys.emplace_back(line);
+    double keysStartTime = getCurrentTime();
+    ModelSource keysSource;
+    if (!keysSource.openAsset(mgr, keysName) || !vocabulary.load(std::move(keysSource))) {
+        std::string textName = getTextKeysName(keysName);
+        ModelSource textSource;
+        if (textName.empty() || !textSource.openAsset(mgr, textName) ||
+            !vocabulary.load(std::move(textSource))) {
+            LOGE(" txt file not found");
+            return;
+        }
+    }
+    loadTiming.keysMs = getCurrentTime() - keysStartTime;
+    LOGI("keys size(%zu)%s", vocabulary.size(), vocabulary.isCompiled() ? ", compiled" : "");
+}
+#endif
+
+void CrnnNet::initModel(const std::string &path, const std::string &keysPath) {
+    double readStartTime = getCurrentTime();
+    modelSource.openFile(path);
+    modelBytes = modelSource.size();
+    loadTiming.readMs = getCurrentTime() - readStartTime;
+    prepackedWeights = getSharedPrepackedWeights(path);
+    session = createSession(getOrtEnv(), modelSource, sessionOptions, "CrnnNet",
+                            GraphOptimizationLevel::ORT_ENABLE_EXTENDED, &loadTiming,
+                            prepackedWeights.get());
+    binding.init(session);
+
+    //load keys
+    double keysStartTime = getCurrentTime();
+    ModelSource keysSource;
+    if (!keysSource.openFile(keysPath) || !vocabulary.load(std::move(keysSource))) {
+        std::string textName = getTextKeysName(keysPath);
+        ModelSource textSource;
+        if (textName.empty() || !textSource.openFile(textName) ||
+            !vocabulary.load(std::move(textSource))) {
+            LOGE(" txt file not found");
+            return;
         }
-        free(buffer);
-    } else {
-        LOGE(" txt file not found");
-        return;
     }
-    keys.insert(keys.begin(),
-                "#"); // blank char for ctc
-    keys.emplace_back(" ");
-    LOGI("keys size(%d)", keys.size());
+    loadTiming.keysMs = getCurrentTime() - keysStartTime;
+    LOGI("keys size(%zu)%s", vocabulary.size(), vocabulary.isCompiled() ? ", compiled" : "");
 }
 
 template<class ForwardIterator>
@@ -90,9 +111,9 @@ inline static size_t argmax(ForwardIterator first, ForwardIterator last) {
     return std::distance(first, std::max_element(first, last));
 }
 
-TextLine CrnnNet::scoreToTextLine(const std::vector<float> &outputData, int h, int w) {
-    auto keySize = keys.size();
-    auto dataSize = outputData.size();
+TextLine CrnnNet::scoreToTextLine(const float *outputData, int h, int w) {
+    auto keySize = vocabulary.size();
+    auto dataSize = (size_t) h * w;
     std::string strRes;
     std::vector<float> scores;
     int lastIndex = 0;
@@ -110,56 +131,42 @@ TextLine CrnnNet::scoreToTextLine(const std::vector<float> &outputData, int h, i
 
         if (maxIndex > 0 && maxIndex < keySize && (!(i > 0 && maxIndex == lastIndex))) {
             scores.emplace_back(maxValue);
-            strRes.append(keys[maxIndex]);
+            vocabulary.append(strRes, maxIndex);
         }
         lastIndex = maxIndex;
     }
     return {strRes, scores};
 }
 
-TextLine CrnnNet::getTextLine(cv::Mat &src) {
+TextLine CrnnNet::getTextLine(cv::Mat &src, NetTiming &timing) {
+    TraceSpan span("CrnnNet::getTextLine");
+    StageTimer timer;
     float scale = (float) dstHeight / (float) src.rows;
     int dstWidth = int((float) src.cols * scale);
 
-    cv::Mat srcResize;
     resize(src, srcResize, cv::Size(dstWidth, dstHeight));
-
-    std::vector<float> inputTensorValues = substractMeanNormalize(srcResize, meanValues,
-                                                                  normValues);
-
-    std::array<int64_t, 4> inputShape{1, srcResize.channels(), srcResize.rows, srcResize.cols};
-
-    auto memoryInfo = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
-
-    Ort::Value inputTensor = Ort::Value::CreateTensor<float>(memoryInfo, inputTensorValues.data(),
-                                                             inputTensorValues.size(),
-                                                             inputShape.data(),
-                                                             inputShape.size());
-    assert(inputTensor.IsTensor());
-    std::vector<const char *> inputNames = {inputNamesPtr.data()->get()};
-    std::vector<const char *> outputNames = {outputNamesPtr.data()->get()};
-    auto outputTensor = session->Run(Ort::RunOptions{nullptr}, inputNames.data(), &inputTensor,
-                                     inputNames.size(), outputNames.data(), outputNames.size());
-
-    assert(outputTensor.size() == 1 && outputTensor.front().IsTensor());
-
-    std::vector<int64_t> outputShape = outputTensor[0].GetTensorTypeAndShapeInfo().GetShape();
-
-    int64_t outputCount = std::accumulate(outputShape.begin(), outputShape.end(), 1,
-                                          std::multiplies<int64_t>());
-
-    float *floatArray = outputTensor.front().GetTensorMutableData<float>();
-    std::vector<float> outputData(floatArray, floatArray + outputCount);
-    return scoreToTextLine(outputData, outputShape[1], outputShape[2]);
+    float *inputData = binding.inputBuffer({1, srcResize.channels(), srcResize.rows, srcResize.cols});
+    substractMeanNormalize(srcResize, meanValues, normValues, inputData);
+    timer.lap(timing.preprocess, "CrnnNet::preprocess");
+
+    std::vector<int64_t> outputShape;
+    const float *outputData = binding.run(getRunOptions("CrnnNet", profiling, runCount),
+                                          outputShape);
+    timer.lap(timing.inference, "CrnnNet::inference");
+
+    TextLine textLine = scoreToTextLine(outputData, outputShape[1], outputShape[2]);
+    timer.lap(timing.postprocess, "CrnnNet::postprocess");
+    return textLine;
 }
 
-std::vector<TextLine> CrnnNet::getTextLines(std::vector<cv::Mat> &partImg) {
+std::vector<TextLine> CrnnNet::getTextLines(std::vector<cv::Mat> &partImg, NetTiming &timing) {
+    TraceSpan span("CrnnNet::getTextLines");
     int size = partImg.size();
     std::vector<TextLine> textLines(size);
     for (int i = 0; i < size; ++i) {
         //getTextLine
         double startCrnnTime = getCurrentTime();
-        TextLine textLine = getTextLine(partImg[i]);
+        TextLine textLine = getTextLine(partImg[i], timing);
         double endCrnnTime = getCurrentTime();
         textLine.time = endCrnnTime - startCrnnTime;
         textLines[i] = textLine;
@@ -1,43 +1,70 @@
 #include "DbNet.h"
 #include "OcrUtils.h"
+#include "ModelSource.h"
+#include "OcrTrace.h"
 #include <numeric>
 
 DbNet::DbNet() {}
 
 DbNet::~DbNet() {
+    binding.reset();
     delete session;
-    inputNamesPtr.clear();
-    outputNamesPtr.clear();
 }
 
 void DbNet::setNumThread(int numOfThread) {
     numThread = numOfThread;
     //===session options===
-    // Sets the number of threads used to parallelize the execution within nodes
-    // A value of 0 means ORT will pick a default
-    sessionOptions.SetIntraOpNumThreads(numThread);
-    //set OMP_NUM_THREADS=16
-
-    // Sets the number of threads used to parallelize the execution of the graph (across nodes)
-    // If sequential execution is enabled this value is ignored
-    // A value of 0 means ORT will pick a default
-    sessionOptions.SetInterOpNumThreads(numThread);
-
-    // Sets graph optimization level
-    // ORT_DISABLE_ALL -> To disable all optimizations
-    // ORT_ENABLE_BASIC -> To enable basic optimizations (Such as redundant node removals)
-    // ORT_ENABLE_EXTENDED -> To enable extended optimizations (Includes level 1 + more complex optimizations like node fusions)
-    // ORT_ENABLE_ALL -> To Enable All possible opitmizations
-    sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+    // 不再为每个session单独建intra/inter线程池，统一使用getOrtEnv()的全局线程池，
+    // 池大小即OcrLite的线程预算
+    setOrtThreadBudget(numThread);
+    sessionOptions.DisablePerSessionThreads();
 }
 
+void DbNet::setProfiling(const std::string &prefix) {
+    profiling = !prefix.empty();
+    if (profiling) {
+        sessionOptions.EnableProfiling(prefix.c_str());
+    } else {
+        sessionOptions.DisableProfiling();
+    }
+}
+
+std::string DbNet::endProfiling() {
+    return endSessionProfiling(session, profiling);
+}
+
+void DbNet::releaseModel() {
+    binding.reset();
+    delete session;
+    session = nullptr;
+    prepackedWeights.reset();
+    modelSource.release();
+}
+
+#ifdef __ANDROID__
 void DbNet::initModel(AAssetManager *mgr, const std::string &name) {
-    int dbModelDataLength = 0;
-    void *dbModelData = getModelDataFromAssets(mgr, name.c_str(), dbModelDataLength);
-    session = new Ort::Session(ortEnv, dbModelData, dbModelDataLength, sessionOptions);
-    free(dbModelData);
-    inputNamesPtr = getInputNames(session);
-    outputNamesPtr = getOutputNames(session);
+    double readStartTime = getCurrentTime();
+    modelSource.openAsset(mgr, name);
+    modelBytes = modelSource.size();
+    loadTiming.readMs = getCurrentTime() - readStartTime;
+    prepackedWeights = getSharedPrepackedWeights(name);
+    session = createSession(getOrtEnv(), modelSource, sessionOptions, "DbNet",
+                            GraphOptimizationLevel::ORT_ENABLE_EXTENDED, &loadTiming,
+                            prepackedWeights.get());
+    binding.init(session);
+}
+#endif
+
+void DbNet::initModel(const std::string &path) {
+    double readStartTime = getCurrentTime();
+    modelSource.openFile(path);
+    modelBytes = modelSource.size();
+    loadTiming.readMs = getCurrentTime() - readStartTime;
+    prepackedWeights = getSharedPrepackedWeights(path);
+    session = createSession(getOrtEnv(), modelSource, sessionOptions, "DbNet",
+                            GraphOptimizationLevel::ORT_ENABLE_EXTENDED, &loadTiming,
+                            prepackedWeights.get());
+    binding.init(session);
 }
 
 std::vector<TextBox> findRsBoxes(const cv::Mat &predMat, const cv::Mat &dilateMat, ScaleParam &s,
@@ -101,56 +128,61 @@ std::vector<TextBox> findRsBoxes(const cv::Mat &predMat, const cv::Mat &dilateMa
 
 std::vector<TextBox>
 DbNet::getTextBoxes(cv::Mat &src, ScaleParam &s, float boxScoreThresh, float boxThresh,
-                    float unClipRatio) {
-    cv::Mat srcResize;
+                    float unClipRatio, NetTiming &timing, DbNetRaw *raw) {
+    TraceSpan span("DbNet::getTextBoxes");
+    StageTimer timer;
     resize(src, srcResize, cv::Size(s.dstWidth, s.dstHeight));
-    std::vector<float> inputTensorValues = substractMeanNormalize(srcResize, meanValues,
-                                                                  normValues);
-
-    std::array<int64_t, 4> inputShape{1, srcResize.channels(), srcResize.rows, srcResize.cols};
-
-    auto memoryInfo = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
-
-    Ort::Value inputTensor = Ort::Value::CreateTensor<float>(memoryInfo, inputTensorValues.data(),
-                                                             inputTensorValues.size(),
-                                                             inputShape.data(),
-                                                             inputShape.size());
-    assert(inputTensor.IsTensor());
-    std::vector<const char *> inputNames = {inputNamesPtr.data()->get()};
-    std::vector<const char *> outputNames = {outputNamesPtr.data()->get()};
-    auto outputTensor = session->Run(Ort::RunOptions{nullptr}, inputNames.data(), &inputTensor,
-                                     inputNames.size(), outputNames.data(), outputNames.size());
-    assert(outputTensor.size() == 1 && outputTensor.front().IsTensor());
-    std::vector<int64_t> outputShape = outputTensor[0].GetTensorTypeAndShapeInfo().GetShape();
-    int64_t outputCount = std::accumulate(outputShape.begin(), outputShape.end(), 1,
-                                          std::multiplies<int64_t>());
-    float *floatArray = outputTensor.front().GetTensorMutableData<float>();
-    std::vector<float> outputData(floatArray, floatArray + outputCount);
+    float *inputData = binding.inputBuffer({1, srcResize.channels(), srcResize.rows, srcResize.cols});
+    substractMeanNormalize(srcResize, meanValues, normValues, inputData);
+    timer.lap(timing.preprocess, "DbNet::preprocess");
+
+    std::vector<int64_t> outputShape;
+    const float *outputData = binding.run(getRunOptions("DbNet", profiling, runCount), outputShape);
+    timer.lap(timing.inference, "DbNet::inference");
 
     //-----Data preparation-----
     int outHeight = outputShape[2];
     int outWidth = outputShape[3];
-    int area = outHeight * outWidth;
 
-    std::vector<float> predData(area, 0.0);
-    std::vector<unsigned char> cbufData(area, ' ');
+    // predMat直接引用输出缓冲区，到下一次Run之前有效
+    cv::Mat predMat(outHeight, outWidth, CV_32F, (void *) outputData);
+    if (raw != nullptr) {
+        predMat.copyTo(raw->probMap);
+        raw->scale = s;
+    }
+    std::vector<TextBox> rsBoxes = postprocess(predMat, s, boxScoreThresh, boxThresh, unClipRatio);
+    timer.lap(timing.postprocess, "DbNet::postprocess");
+    return rsBoxes;
+}
 
+std::vector<TextBox>
+DbNet::refilterTextBoxes(DbNetRaw &raw, float boxScoreThresh, float boxThresh, float unClipRatio,
+                         NetTiming &timing) {
+    TraceSpan span("DbNet::refilterTextBoxes");
+    StageTimer timer;
+    std::vector<TextBox> rsBoxes = postprocess(raw.probMap, raw.scale, boxScoreThresh, boxThresh,
+                                               unClipRatio);
+    timer.lap(timing.postprocess, "DbNet::postprocess");
+    return rsBoxes;
+}
+
+std::vector<TextBox>
+DbNet::postprocess(const cv::Mat &predMat, ScaleParam &s, float boxScoreThresh, float boxThresh,
+                   float unClipRatio) {
+    int area = predMat.rows * predMat.cols;
+    const float *outputData = predMat.ptr<float>();
+    cBufMat.create(predMat.rows, predMat.cols, CV_8UC1);
+    unsigned char *cbufData = cBufMat.data;
     for (int i = 0; i < area; i++) {
-        predData[i] = float(outputData[i]);
         cbufData[i] = (unsigned char) ((outputData[i]) * 255);
     }
 
-    cv::Mat predMat(outHeight, outWidth, CV_32F, (float *) predData.data());
-    cv::Mat cBufMat(outHeight, outWidth, CV_8UC1, (unsigned char *) cbufData.data());
-
     //-----boxThresh-----
     const double maxValue = 255;
     const double threshold = boxThresh * 255;
-    cv::Mat thresholdMat;
     cv::threshold(cBufMat, thresholdMat, threshold, maxValue, cv::THRESH_BINARY);
 
     //-----dilate-----
-    cv::Mat dilateMat;
     cv::Mat dilateElement = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(2, 2));
     cv::dilate(thresholdMat, dilateMat, dilateElement);
 
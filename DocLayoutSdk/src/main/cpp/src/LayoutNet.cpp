@@ -1,21 +1,16 @@
+#define TAG "LayoutNet"
+
 #include "LayoutNet.h"
+#include "OcrUtils.h"
 #include "onnxruntime/core/session/onnxruntime_cxx_api.h"
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
-#include <android/asset_manager.h>
-#include <android/asset_manager_jni.h>
-#include <android/log.h>
 #include <vector>
 #include <string>
 #include <algorithm>
 #include <chrono>
-
-#define TAG "LayoutNet"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, TAG, __VA_ARGS__)
-
-// DOCLAYOUT_DOCSTRUCTBENCH 模型配置
-const int INPUT_WIDTH = 1024;
-const int INPUT_HEIGHT = 1024;
+#include <cmath>
+#include <iterator>
 
 // DOCLAYOUT_DOCSTRUCTBENCH 支持的10个类别
 static const std::vector<std::string> DOCLAYOUT_CLASSES = {
@@ -23,12 +18,15 @@ static const std::vector<std::string> DOCLAYOUT_CLASSES = {
     "table", "table_caption", "table_footnote", "isolate_formula", "formula_caption"
 };
 
+const int LayoutNet::INPUT_TIERS[3] = {640, 800, 1024};
+
 LayoutNet::LayoutNet() : session(nullptr) {
     LOGI("LayoutNet constructor - CDLA support");
 }
 
 LayoutNet::~LayoutNet() {
     if (session) {
+        binding.reset();
         delete session;
         session = nullptr;
     }
@@ -37,94 +35,397 @@ LayoutNet::~LayoutNet() {
 
 void LayoutNet::setNumThread(int numOfThread) {
     numThread = numOfThread;
-    sessionOptions.SetIntraOpNumThreads(numThread);
-    sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+    // 使用getOrtEnv()的全局线程池
+    setOrtThreadBudget(numThread);
+    sessionOptions.DisablePerSessionThreads();
     LOGI("Set threads: %d", numThread);
 }
 
+void LayoutNet::setProfiling(const std::string &prefix) {
+    profiling = !prefix.empty();
+    if (profiling) {
+        sessionOptions.EnableProfiling(prefix.c_str());
+    } else {
+        sessionOptions.DisableProfiling();
+    }
+}
+
+std::string LayoutNet::endProfiling() {
+    return endSessionProfiling(session, profiling);
+}
+
+void LayoutNet::releaseModel() {
+    binding.reset();
+    delete session;
+    session = nullptr;
+    prepackedWeights.reset();
+    modelSource.release();
+    fastNet.reset();
+}
+
+#ifdef __ANDROID__
 void LayoutNet::initModel(AAssetManager *mgr, const std::string &name) {
     LOGI("Loading CDLA model: %s", name.c_str());
 
-    // 从 Android Assets 加载模型
-    AAsset* asset = AAssetManager_open(mgr, name.c_str(), AASSET_MODE_BUFFER);
-    if (!asset) {
+    // 从 Android Assets 映射模型，不复制
+    double readStartTime = getCurrentTime();
+    if (!modelSource.openAsset(mgr, name)) {
         LOGI("Failed to open model asset: %s", name.c_str());
         return;
     }
 
-    size_t modelSize = AAsset_getLength(asset);
-    const void* modelData = AAsset_getBuffer(asset);
-
-    LOGI("Model size: %zu bytes", modelSize);
+    modelBytes = modelSource.size();
+    loadTiming.readMs = getCurrentTime() - readStartTime;
+    LOGI("Model size: %zu bytes", modelBytes);
 
     try {
         // 创建 ONNX Runtime Session
-        session = new Ort::Session(ortEnv, modelData, modelSize, sessionOptions);
+        prepackedWeights = getSharedPrepackedWeights(name);
+        session = createSession(getOrtEnv(), modelSource, sessionOptions, netName,
+                                GraphOptimizationLevel::ORT_ENABLE_EXTENDED, &loadTiming,
+                                prepackedWeights.get());
+        binding.init(session);
+        readInputShape();
         LOGI("CDLA model loaded successfully");
-
-        AAsset_close(asset);
+        if (!cascadeModel.empty()) createFastNet()->initModel(mgr, cascadeModel);
     } catch (const std::exception& e) {
         LOGI("Failed to create ONNX session: %s", e.what());
-        AAsset_close(asset);
+        modelSource.release();
     }
 }
+#endif
 
-// DOCLAYOUT_DOCSTRUCTBENCH 预处理 - Letterbox实现（与Python保持一致）
-cv::Mat LayoutNet::preprocessImage(const cv::Mat &src) {
-    // Letterbox预处理 - 保持宽高比，添加灰色填充
-    cv::Size srcSize = src.size();
+void LayoutNet::initModel(const std::string &path) {
+    LOGI("Loading CDLA model: %s", path.c_str());
 
-    // 计算缩放比例（保持宽高比）
-    float r = std::min(static_cast<float>(INPUT_WIDTH) / srcSize.width,
-                       static_cast<float>(INPUT_HEIGHT) / srcSize.height);
+    try {
+        // 映射模型文件创建 ONNX Runtime Session
+        double readStartTime = getCurrentTime();
+        modelSource.openFile(path);
+        modelBytes = modelSource.size();
+        loadTiming.readMs = getCurrentTime() - readStartTime;
+        prepackedWeights = getSharedPrepackedWeights(path);
+        session = createSession(getOrtEnv(), modelSource, sessionOptions, netName,
+                                GraphOptimizationLevel::ORT_ENABLE_EXTENDED, &loadTiming,
+                                prepackedWeights.get());
+        binding.init(session);
+        readInputShape();
+        LOGI("CDLA model loaded successfully");
+        if (!cascadeModel.empty()) createFastNet()->initModel(cascadeModel);
+    } catch (const std::exception& e) {
+        LOGE("Failed to create ONNX session: %s", e.what());
+    }
+}
 
-    // 计算resize后的尺寸
-    cv::Size newUnpad(static_cast<int>(round(srcSize.width * r)),
-                      static_cast<int>(round(srcSize.height * r)));
+void LayoutNet::setCascade(const std::string &fastModel, const LayoutCascadeConfig &config) {
+    cascadeModel = fastModel;
+    cascadeConfig = config;
+}
 
-    // 计算padding
-    float dw = static_cast<float>(INPUT_WIDTH - newUnpad.width);
-    float dh = static_cast<float>(INPUT_HEIGHT - newUnpad.height);
+LayoutNet *LayoutNet::createFastNet() {
+    LOGI("LayoutNet cascade: loading fast model %s", cascadeModel.c_str());
+    fastNet.reset(new LayoutNet());
+    fastNet->netName = "LayoutNetFast";
+    fastNet->setNumThread(numThread);
+    fastNet->setInputSize(cascadeConfig.fastInputSize);
+    fastNet->renderEnabled = false;
+    return fastNet.get();
+}
 
-    // 居中padding
-    int padW = static_cast<int>(round(dw / 2.0f - 0.1f));
-    int padH = static_cast<int>(round(dh / 2.0f - 0.1f));
-    int padBottom = static_cast<int>(round(dh / 2.0f + 0.1f));
-    int padRight = static_cast<int>(round(dw / 2.0f + 0.1f));
+void LayoutNet::setInputSize(int size) {
+    if (size != 0 && (size % INPUT_STRIDE != 0 || size < MIN_INPUT_SIZE || size > INPUT_WIDTH)) {
+        LOGE("LayoutNet input size %d invalid, must be 0 or a multiple of %d in [%d, %d]",
+             size, INPUT_STRIDE, MIN_INPUT_SIZE, INPUT_WIDTH);
+        return;
+    }
+    inputSize = size;
+    if (session != nullptr && !dynamicInput && size != modelInputSize.width) {
+        LOGW("LayoutNet model input is fixed at %dx%d, input size %d ignored",
+             modelInputSize.width, modelInputSize.height, size);
+    }
+}
 
-    LOGI("Letterbox: src_size=(%d,%d), scale=%.3f, new_size=(%d,%d), pad=(%d,%d,%d,%d)",
-         srcSize.width, srcSize.height, r, newUnpad.width, newUnpad.height,
-         padW, padH, padRight, padBottom);
+void LayoutNet::setRectInput(bool enabled) {
+    rectInput = enabled;
+    if (enabled && session != nullptr && !dynamicInput) {
+        LOGW("LayoutNet model input is fixed at %dx%d, rect input ignored",
+             modelInputSize.width, modelInputSize.height);
+    }
+}
 
-    // Resize图像
-    cv::Mat resized;
-    cv::resize(src, resized, newUnpad);
+std::vector<int> LayoutNet::getCandidateInputSizes() const {
+    if (!dynamicInput) return {modelInputSize.width};
+    int size = inputSize;
+    if (size > 0) return {size};
+    return std::vector<int>(std::begin(INPUT_TIERS), std::end(INPUT_TIERS));
+}
 
-    // 转换BGR到RGB
-    cv::Mat rgb;
-    cv::cvtColor(resized, rgb, cv::COLOR_BGR2RGB);
+void LayoutNet::readInputShape() {
+    std::vector<int64_t> shape = session->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+    dynamicInput = shape.size() == 4 && shape[2] <= 0 && shape[3] <= 0;
+    dynamicBatch = shape.size() == 4 && shape[0] <= 0;
+    if (!dynamicInput && shape.size() == 4 && shape[2] > 0 && shape[3] > 0) {
+        modelInputSize = cv::Size((int) shape[3], (int) shape[2]);
+    }
+    int size = inputSize;
+    if (dynamicInput) {
+        LOGI("LayoutNet input dynamic, size %d (0 = auto)", size);
+    } else {
+        LOGI("LayoutNet input fixed, %dx%d", modelInputSize.width, modelInputSize.height);
+    }
+    LOGI("LayoutNet batch %s", dynamicBatch ? "dynamic" : "fixed");
+    if (!dynamicInput && size != modelInputSize.width) {
+        LOGW("LayoutNet model input is fixed, input size %d ignored", size);
+    }
+}
 
-    // 添加灰色填充(114,114,114) - 与Python LetterBox保持一致
-    cv::Mat padded;
-    cv::copyMakeBorder(rgb, padded, padH, padBottom, padW, padRight,
-                      cv::BORDER_CONSTANT, cv::Scalar(114, 114, 114));
+cv::Size LayoutNet::resolveInputSize(const cv::Mat &src, int forcedSize) const {
+    if (!dynamicInput) return modelInputSize;
+    int size = forcedSize > 0 ? forcedSize : inputSize.load();
+    if (size <= 0) size = selectInputSize(src);
+    return cv::Size(size, size);
+}
 
-    // 确保尺寸正确
-    if (padded.size() != cv::Size(INPUT_WIDTH, INPUT_HEIGHT)) {
-        cv::resize(padded, padded, cv::Size(INPUT_WIDTH, INPUT_HEIGHT));
+// 长边不超过thumbLong的灰度缩略图，返回缩放比例
+static float grayThumbnail(const cv::Mat &src, int thumbLong, cv::Mat &gray) {
+    int longSide = std::max(src.cols, src.rows);
+    float s = std::min(1.0f, static_cast<float>(thumbLong) / longSide);
+    cv::Mat thumb;
+    cv::resize(src, thumb, cv::Size(std::max(1, static_cast<int>(src.cols * s)),
+                                    std::max(1, static_cast<int>(src.rows * s))),
+               0, 0, cv::INTER_AREA);
+    cv::cvtColor(thumb, gray, cv::COLOR_BGR2GRAY);
+    return s;
+}
+
+// 缩略图上低于此灰度的像素视为墨迹
+static const unsigned char INK_THRESH = 160;
+
+// 自动选档：
+// 1. 页面长边不超过某一档时不再用更大的档位，更大只是把同样的像素插值放大；
+// 2. 在长边256的灰度缩略图上估计内容密度：墨迹像素占比，以及按列投影的空白竖条数出的分栏数。
+//    单栏、稀疏的页面用640即可（FLOPs约为1024的0.39），双栏或中等密度用800，
+//    三栏以上、表格公式密集的页面小目标多，仍用1024。
+// 墨迹占比0.06/0.12与分栏数2/3是未经校准的初始值，尚未在真实页面集上测过，
+// 应以RapidOcrLayoutTierBench在目标页面上的召回率/延迟调整
+static const float TIER_INK_MEDIUM = 0.06f;
+static const float TIER_INK_DENSE = 0.12f;
+static const int TIER_COLUMNS_MEDIUM = 2;
+static const int TIER_COLUMNS_DENSE = 3;
+
+int LayoutNet::selectInputSize(const cv::Mat &src) const {
+    const int tierCount = sizeof(INPUT_TIERS) / sizeof(INPUT_TIERS[0]);
+    int longSide = std::max(src.cols, src.rows);
+    int cap = INPUT_TIERS[tierCount - 1];
+    for (int tier : INPUT_TIERS) {
+        if (longSide <= tier) {
+            cap = tier;
+            break;
+        }
+    }
+    if (cap == INPUT_TIERS[0]) return cap;
+
+    cv::Mat gray;
+    grayThumbnail(src, 256, gray);
+
+    std::vector<int> columnInk(gray.cols, 0);
+    long inkCount = 0;
+    for (int y = 0; y < gray.rows; ++y) {
+        const unsigned char *row = gray.ptr<unsigned char>(y);
+        for (int x = 0; x < gray.cols; ++x) {
+            if (row[x] < INK_THRESH) {
+                columnInk[x]++;
+                inkCount++;
+            }
+        }
+    }
+    float inkRatio = static_cast<float>(inkCount) / (gray.rows * gray.cols);
+
+    // 左右各去掉5%页边，数被足够宽的空白竖条分开的内容段
+    int x0 = gray.cols / 20, x1 = gray.cols - gray.cols / 20;
+    int minGap = std::max(2, gray.cols / 50);
+    int emptyThresh = gray.rows / 100;
+    int columns = 0, gap = minGap;
+    for (int x = x0; x < x1; ++x) {
+        if (columnInk[x] <= emptyThresh) {
+            gap++;
+            continue;
+        }
+        if (gap >= minGap) columns++;
+        gap = 0;
+    }
+
+    int size;
+    if (columns >= TIER_COLUMNS_DENSE || inkRatio >= TIER_INK_DENSE) {
+        size = INPUT_TIERS[2];
+    } else if (columns == TIER_COLUMNS_MEDIUM || inkRatio >= TIER_INK_MEDIUM) {
+        size = INPUT_TIERS[1];
+    } else {
+        size = INPUT_TIERS[0];
+    }
+    LOGI("LayoutNet auto input size: long=%d ink=%.3f columns=%d -> %d",
+         longSide, inkRatio, columns, std::min(size, cap));
+    return std::min(size, cap);
+}
+
+float LayoutNet::inkCoverage(const cv::Mat &src, const std::vector<LayoutBox> &boxes) {
+    cv::Mat gray;
+    float s = grayThumbnail(src, 256, gray);
+    // 检测框按缩略图比例向外取整后涂进掩码
+    cv::Mat covered = cv::Mat::zeros(gray.size(), CV_8UC1);
+    const cv::Rect bounds(0, 0, covered.cols, covered.rows);
+    for (const auto &box : boxes) {
+        cv::Rect rect(cv::Point(static_cast<int>(box.boxPoint[0].x * s),
+                                static_cast<int>(box.boxPoint[0].y * s)),
+                      cv::Point(static_cast<int>(std::ceil(box.boxPoint[2].x * s)),
+                                static_cast<int>(std::ceil(box.boxPoint[2].y * s))));
+        rect &= bounds;
+        if (rect.area() > 0) covered(rect).setTo(cv::Scalar(255));
+    }
+
+    long ink = 0, inkCovered = 0;
+    for (int y = 0; y < gray.rows; ++y) {
+        const unsigned char *row = gray.ptr<unsigned char>(y);
+        const unsigned char *mask = covered.ptr<unsigned char>(y);
+        for (int x = 0; x < gray.cols; ++x) {
+            if (row[x] < INK_THRESH) {
+                ink++;
+                if (mask[x]) inkCovered++;
+            }
+        }
+    }
+    return ink > 0 ? static_cast<float>(inkCovered) / ink : 1.0f;
+}
+
+// 放行条件按开销从小到大检查：复杂区域、平均置信度，最后才算墨迹覆盖率
+bool LayoutNet::acceptFastResult(const cv::Mat &src, const LayoutResult &fast) const {
+    const LayoutCascadeConfig &config = cascadeConfig;
+    const std::vector<LayoutBox> &boxes = fast.layoutBoxes;
+    float meanScore = 1.0f;
+    bool complex = false;
+    if (!boxes.empty()) {
+        float scoreSum = 0.0f;
+        for (const auto &box : boxes) {
+            scoreSum += box.score;
+            complex |= box.type == LayoutType::FIGURE || box.type == LayoutType::TABLE ||
+                       box.type == LayoutType::ISOLATE_FORMULA;
+        }
+        meanScore = scoreSum / boxes.size();
     }
+    bool accept = !(config.escalateComplex && complex) && meanScore >= config.minMeanScore;
+    float coverage = -1.0f;
+    if (accept) {
+        coverage = inkCoverage(src, boxes);
+        accept = coverage >= config.minInkCoverage;
+    }
+    LOGI("LayoutNet cascade: boxes=%zu meanScore=%.3f complex=%d coverage=%.3f -> %s",
+         boxes.size(), meanScore, complex ? 1 : 0, coverage, accept ? "fast" : "escalate");
+    return accept;
+}
 
-    // 归一化到[0,1]
-    cv::Mat normalized;
-    padded.convertTo(normalized, CV_32F, 1.0/255.0);
+LayoutNet::Letterbox LayoutNet::computeLetterbox(const cv::Size &srcSize, const cv::Size &targetSize,
+                                                 bool rect) {
+    Letterbox letterbox;
+    // 计算缩放比例（保持宽高比）
+    letterbox.gain = std::min(static_cast<float>(targetSize.width) / srcSize.width,
+                              static_cast<float>(targetSize.height) / srcSize.height);
+    // 计算resize后的尺寸
+    letterbox.newUnpad = cv::Size(static_cast<int>(round(srcSize.width * letterbox.gain)),
+                                  static_cast<int>(round(srcSize.height * letterbox.gain)));
+    letterbox.inputSize = targetSize;
+    if (rect) {
+        // 长边已等于目标边长（32的倍数），短边向上补到步长的倍数。按截断后的尺寸取整（与Python的int()一致），
+        // 否则四舍五入进位的那1像素会多补一整个步长；resize尺寸相应不超过输入
+        int floorW = static_cast<int>(srcSize.width * letterbox.gain);
+        int floorH = static_cast<int>(srcSize.height * letterbox.gain);
+        letterbox.inputSize = cv::Size((floorW + INPUT_STRIDE - 1) / INPUT_STRIDE * INPUT_STRIDE,
+                                       (floorH + INPUT_STRIDE - 1) / INPUT_STRIDE * INPUT_STRIDE);
+        letterbox.newUnpad.width = std::min(letterbox.newUnpad.width, letterbox.inputSize.width);
+        letterbox.newUnpad.height = std::min(letterbox.newUnpad.height, letterbox.inputSize.height);
+    }
+    centerPadding(letterbox);
+    return letterbox;
+}
 
-    return normalized;
+void LayoutNet::centerPadding(Letterbox &letterbox) {
+    // 居中padding；两侧取整后之和恰为dw/dh，不需要再resize补齐
+    float dw = static_cast<float>(letterbox.inputSize.width - letterbox.newUnpad.width);
+    float dh = static_cast<float>(letterbox.inputSize.height - letterbox.newUnpad.height);
+    letterbox.padLeft = static_cast<int>(round(dw / 2.0f - 0.1f));
+    letterbox.padTop = static_cast<int>(round(dh / 2.0f - 0.1f));
+}
+
+// DOCLAYOUT_DOCSTRUCTBENCH 预处理 - Letterbox实现（与Python保持一致）
+// 单遍完成：resize后的BGR行直接拆成RGB三个平面写进dst，同时填114灰边并乘1/255，
+// 不再生成RGB、padding、float和CHW转置四份整图临时数据
+void LayoutNet::preprocessImage(const cv::Mat &src, const Letterbox &letterbox, float *dst) {
+    // Letterbox预处理 - 保持宽高比，添加灰色填充
+    cv::Size srcSize = src.size();
+    const cv::Size newUnpad = letterbox.newUnpad;
+    const int inputW = letterbox.inputSize.width;
+    const int inputH = letterbox.inputSize.height;
+    const int padW = letterbox.padLeft;
+    const int padH = letterbox.padTop;
+
+    LOGI("Letterbox: src_size=(%d,%d), scale=%.3f, new_size=(%d,%d), input=(%d,%d), pad=(%d,%d,%d,%d)",
+         srcSize.width, srcSize.height, letterbox.gain, newUnpad.width, newUnpad.height,
+         inputW, inputH, padW, padH, inputW - newUnpad.width - padW,
+         inputH - newUnpad.height - padH);
+
+    // Resize图像（仍是BGR uint8，缓冲区复用）
+    const cv::Mat *resized = &src;
+    if (newUnpad != srcSize) {
+        cv::resize(src, resizeMat, newUnpad);
+        resized = &resizeMat;
+    }
+
+    // 归一化到[0,1]的查表，灰色填充(114,114,114) - 与Python LetterBox保持一致
+    float lut[256];
+    for (int i = 0; i < 256; ++i) {
+        lut[i] = static_cast<float>(i) / 255.0f;
+    }
+    const float padValue = lut[114];
+    const int planeSize = inputH * inputW;
+    const int imgW = newUnpad.width;
+    const int imgH = newUnpad.height;
+
+    cv::parallel_for_(cv::Range(0, inputH), [&](const cv::Range &range) {
+        for (int y = range.start; y < range.end; ++y) {
+            float *rowR = dst + y * inputW;
+            float *rowG = rowR + planeSize;
+            float *rowB = rowG + planeSize;
+            int sy = y - padH;
+            if (sy < 0 || sy >= imgH) {
+                std::fill(rowR, rowR + inputW, padValue);
+                std::fill(rowG, rowG + inputW, padValue);
+                std::fill(rowB, rowB + inputW, padValue);
+                continue;
+            }
+            std::fill(rowR, rowR + padW, padValue);
+            std::fill(rowG, rowG + padW, padValue);
+            std::fill(rowB, rowB + padW, padValue);
+            // BGR交错 -> RGB平面
+            const unsigned char *srcRow = resized->ptr<unsigned char>(sy);
+            float *outR = rowR + padW;
+            float *outG = rowG + padW;
+            float *outB = rowB + padW;
+            for (int x = 0; x < imgW; ++x) {
+                outB[x] = lut[srcRow[3 * x]];
+                outG[x] = lut[srcRow[3 * x + 1]];
+                outR[x] = lut[srcRow[3 * x + 2]];
+            }
+            std::fill(rowR + padW + imgW, rowR + inputW, padValue);
+            std::fill(rowG + padW + imgW, rowG + inputW, padValue);
+            std::fill(rowB + padW + imgW, rowB + inputW, padValue);
+        }
+    });
 }
 
 // 解析YOLOv8格式输出
-std::vector<LayoutBox> LayoutNet::parseYOLOv8Output(float* outputData,
+std::vector<LayoutBox> LayoutNet::parseYOLOv8Output(const float* outputData,
                                                    const std::vector<int64_t>& outputShape,
                                                    const cv::Mat& src,
+                                                   const Letterbox &letterbox,
                                                    float confThreshold) {
     std::vector<LayoutBox> boxes;
 
@@ -139,16 +440,16 @@ std::vector<LayoutBox> LayoutNet::parseYOLOv8Output(float* outputData,
     LOGI("Parsing YOLOv8 output: detections=%d, features=%d", numDetections, numFeatures);
 
     // DOCLAYOUT_DOCSTRUCTBENCH 使用scale_boxes逻辑
-    // 计算gain和padding，与Python的scale_boxes保持一致
-    float gain = std::min(static_cast<float>(INPUT_WIDTH) / src.cols,
-                          static_cast<float>(INPUT_HEIGHT) / src.rows);
-
-    // 计算padding
-    int padW = static_cast<int>(round((INPUT_WIDTH - src.cols * gain) / 2.0f - 0.1f));
-    int padH = static_cast<int>(round((INPUT_HEIGHT - src.rows * gain) / 2.0f - 0.1f));
+    // 与Python的scale_boxes一致，直接用预处理实际施加的gain和左/上padding：
+    // rect模式下padding只有几个像素且两侧可能不等，按输入尺寸重新推算会差1
+    const int inputW = letterbox.inputSize.width;
+    const int inputH = letterbox.inputSize.height;
+    float gain = letterbox.gain;
+    int padW = letterbox.padLeft;
+    int padH = letterbox.padTop;
 
     LOGI("scale_boxes: gain=%.3f, pad=(%d,%d), src_size=(%d,%d), input_size=(%d,%d)",
-         gain, padW, padH, src.cols, src.rows, INPUT_WIDTH, INPUT_HEIGHT);
+         gain, padW, padH, src.cols, src.rows, inputW, inputH);
 
     for (int i = 0; i < numDetections; ++i) {
         // DOCLAYOUT_DOCSTRUCTBENCH 格式: [x1, y1, x2, y2, conf, class_id]
@@ -219,83 +520,165 @@ std::vector<LayoutBox> LayoutNet::parseYOLOv8Output(float* outputData,
     return boxes;
 }
 
-// 计算IoU
-float LayoutNet::calculateIoU(const LayoutBox &box1, const LayoutBox &box2) {
-    cv::Rect rect1(box1.boxPoint[0].x, box1.boxPoint[0].y,
-                   box1.boxPoint[2].x - box1.boxPoint[0].x,
-                   box1.boxPoint[2].y - box1.boxPoint[0].y);
-    cv::Rect rect2(box2.boxPoint[0].x, box2.boxPoint[0].y,
-                   box2.boxPoint[2].x - box2.boxPoint[0].x,
-                   box2.boxPoint[2].y - box2.boxPoint[0].y);
-
-    cv::Rect intersection = rect1 & rect2;
-    cv::Rect union_ = rect1 | rect2;
-
-    if (union_.area() == 0) return 0.0f;
-    return static_cast<float>(intersection.area()) / static_cast<float>(union_.area());
+void LayoutNet::nmsIndices(NmsBuffer &buffer, float iouThreshold) {
+    const int n = static_cast<int>(buffer.score.size());
+    const float *x1 = buffer.x1.data(), *y1 = buffer.y1.data();
+    const float *x2 = buffer.x2.data(), *y2 = buffer.y2.data();
+    const float *area = buffer.area.data(), *score = buffer.score.data();
+    const int *classId = buffer.classId.data();
+
+    // 一次排序：类别升序、同类分数降序，分数相同按下标保证结果确定
+    buffer.order.resize(n);
+    for (int i = 0; i < n; ++i) buffer.order[i] = i;
+    std::sort(buffer.order.begin(), buffer.order.end(), [&](int a, int b) {
+        if (classId[a] != classId[b]) return classId[a] < classId[b];
+        if (score[a] != score[b]) return score[a] > score[b];
+        return a < b;
+    });
+
+    // 贪心：按顺序遍历，与本类已保留的框IoU都不超过阈值则保留。保留框远少于候选框，
+    // 比较次数为 候选数×保留数，不再是候选数的平方
+    buffer.keep.clear();
+    size_t classStart = 0;
+    for (int k = 0; k < n; ++k) {
+        const int i = buffer.order[k];
+        if (k > 0 && classId[i] != classId[buffer.order[k - 1]]) classStart = buffer.keep.size();
+        bool suppressed = false;
+        for (size_t m = classStart; m < buffer.keep.size(); ++m) {
+            const int j = buffer.keep[m];
+            float iw = std::min(x2[i], x2[j]) - std::max(x1[i], x1[j]);
+            float ih = std::min(y2[i], y2[j]) - std::max(y1[i], y1[j]);
+            if (iw <= 0.0f || ih <= 0.0f) continue;
+            float inter = iw * ih;
+            // inter / (area_i + area_j - inter) > threshold，不做除法
+            if (inter > iouThreshold * (area[i] + area[j] - inter)) {
+                suppressed = true;
+                break;
+            }
+        }
+        if (!suppressed) buffer.keep.push_back(i);
+    }
 }
 
 // Per-class NMS过滤重叠框 - 与Python multiclass_nms保持一致
 std::vector<LayoutBox> LayoutNet::nmsBoxes(std::vector<LayoutBox> &boxes, float iouThreshold) {
     if (boxes.empty()) return boxes;
 
-    LOGI("Applying per-class NMS with IoU threshold: %.2f", iouThreshold);
-
-    // 按类别分组
-    std::map<int, std::vector<LayoutBox>> classGroups;
-    for (const auto& box : boxes) {
-        int classId = static_cast<int>(box.type);
-        classGroups[classId].push_back(box);
+    // 只把坐标、分数和类别抄进紧凑的缓冲区，排序和IoU计算不再碰LayoutBox里的点数组和字符串
+    NmsBuffer &buffer = nmsBuffer;
+    const size_t n = boxes.size();
+    buffer.x1.resize(n);
+    buffer.y1.resize(n);
+    buffer.x2.resize(n);
+    buffer.y2.resize(n);
+    buffer.area.resize(n);
+    buffer.score.resize(n);
+    buffer.classId.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const LayoutBox &box = boxes[i];
+        buffer.x1[i] = static_cast<float>(box.boxPoint[0].x);
+        buffer.y1[i] = static_cast<float>(box.boxPoint[0].y);
+        buffer.x2[i] = static_cast<float>(box.boxPoint[2].x);
+        buffer.y2[i] = static_cast<float>(box.boxPoint[2].y);
+        buffer.area[i] = (buffer.x2[i] - buffer.x1[i]) * (buffer.y2[i] - buffer.y1[i]);
+        buffer.score[i] = box.score;
+        buffer.classId[i] = static_cast<int>(box.type);
     }
 
-    std::vector<LayoutBox> result;
-    int totalBeforeNMS = static_cast<int>(boxes.size());
-    int totalAfterNMS = 0;
+    nmsIndices(buffer, iouThreshold);
 
-    // 对每个类别单独应用NMS
-    for (auto& pair : classGroups) {
-        int classId = pair.first;
-        std::vector<LayoutBox>& classBoxes = pair.second;
+    std::vector<LayoutBox> result;
+    result.reserve(buffer.keep.size());
+    for (int i : buffer.keep) result.push_back(std::move(boxes[i]));
 
-        LOGI("Processing class %d (%s): %d boxes before NMS",
-             classId, classId < DOCLAYOUT_CLASSES.size() ? DOCLAYOUT_CLASSES[classId].c_str() : "unknown",
-             static_cast<int>(classBoxes.size()));
+    LOGI("Per-class NMS (IoU %.2f): %zu -> %zu boxes", iouThreshold, n, result.size());
+    return result;
+}
 
-        // 按分数降序排序
-        std::sort(classBoxes.begin(), classBoxes.end(), [](const LayoutBox& a, const LayoutBox& b) {
-            return a.score > b.score;
-        });
+// 快速模型的耗时计入升级后的结果
+static void addFastTiming(const LayoutResult &fast, LayoutResult &result) {
+    result.stage = LayoutStage::Escalated;
+    result.layoutNetTime += fast.layoutNetTime;
+    result.timing.layoutNet += fast.timing.layoutNet;
+}
 
-        std::vector<LayoutBox> classResult;
-        std::vector<bool> suppressed(classBoxes.size(), false);
+LayoutResult LayoutNet::getLayoutBoxes(cv::Mat &src, float boxScoreThresh, int forcedInputSize,
+                                       RawOutput *raw) {
+    if (forcedInputSize > 0 || !hasCascade()) {
+        return runLayout(src, boxScoreThresh, forcedInputSize, raw);
+    }
 
-        // 应用NMS
-        for (size_t i = 0; i < classBoxes.size(); ++i) {
-            if (suppressed[i]) continue;
+    fastNet->rectInput = rectInput.load();
+    LayoutResult fast = fastNet->runLayout(src, boxScoreThresh, 0, raw);
+    StageTimer timer;
+    bool accept = acceptFastResult(src, fast);
+    timer.lap(fast.timing.layoutNet.postprocess, "LayoutNet::cascadeGate");
+    if (accept) {
+        fast.stage = LayoutStage::Fast;
+        if (raw != nullptr) raw->stage = LayoutStage::Fast;
+        renderLayoutResult(src, timer, fast);
+        fast.layoutNetTime += fast.timing.layoutNet.render.wallTime;
+        return fast;
+    }
+    // 完整模型失败时不能留下快速模型的输出冒充升级结果
+    if (raw != nullptr) {
+        raw->shape.clear();
+        raw->data.clear();
+    }
+    LayoutResult result = runLayout(src, boxScoreThresh, 0, raw);
+    addFastTiming(fast, result);
+    if (raw != nullptr) raw->stage = LayoutStage::Escalated;
+    return result;
+}
 
-            classResult.push_back(classBoxes[i]);
+LayoutResult LayoutNet::refilter(const RawOutput &raw, float boxScoreThresh) {
+    LayoutResult result;
+    StageTimer timer;
+    NetTiming &timing = result.timing.layoutNet;
+    cv::Mat src = raw.src;
+    result.inputSize = raw.letterbox.inputSize;
+    result.stage = raw.stage;
+    decodeLayoutResult(src, raw.data.data(), raw.shape, raw.letterbox, boxScoreThresh, timer, result);
+    result.layoutNetTime = timing.postprocess.wallTime + timing.nms.wallTime + timing.render.wallTime;
+    return result;
+}
 
-            // 只抑制同类的重叠框
-            for (size_t j = i + 1; j < classBoxes.size(); ++j) {
-                if (!suppressed[j] && calculateIoU(classBoxes[i], classBoxes[j]) > iouThreshold) {
-                    suppressed[j] = true;
-                }
-            }
+std::vector<LayoutResult> LayoutNet::getLayoutBoxesBatch(std::vector<cv::Mat> &pages,
+                                                         float boxScoreThresh, int maxBatch) {
+    if (!hasCascade()) return runLayoutPages(pages, boxScoreThresh, maxBatch);
+
+    fastNet->rectInput = rectInput.load();
+    std::vector<LayoutResult> results = fastNet->runLayoutPages(pages, boxScoreThresh, maxBatch);
+    std::vector<cv::Mat> escalated;
+    std::vector<size_t> escalatedIndex;
+    for (size_t i = 0; i < pages.size(); ++i) {
+        if (pages[i].empty()) continue;
+        StageTimer timer;
+        bool accept = acceptFastResult(pages[i], results[i]);
+        timer.lap(results[i].timing.layoutNet.postprocess, "LayoutNet::cascadeGate");
+        if (accept) {
+            results[i].stage = LayoutStage::Fast;
+            renderLayoutResult(pages[i], timer, results[i]);
+            results[i].layoutNetTime += results[i].timing.layoutNet.render.wallTime;
+        } else {
+            escalated.push_back(pages[i]);
+            escalatedIndex.push_back(i);
         }
-
-        LOGI("Class %d: %d boxes after NMS", classId, static_cast<int>(classResult.size()));
-        result.insert(result.end(), classResult.begin(), classResult.end());
-        totalAfterNMS += static_cast<int>(classResult.size());
     }
-
-    LOGI("Per-class NMS completed: %d -> %d boxes (%.1f%% reduction)",
-         totalBeforeNMS, totalAfterNMS,
-         totalBeforeNMS > 0 ? (1.0 - static_cast<float>(totalAfterNMS) / totalBeforeNMS) * 100.0f : 0.0f);
-
-    return result;
+    LOGI("LayoutNet cascade: %zu of %zu pages escalated", escalated.size(), pages.size());
+    if (escalated.empty()) return results;
+
+    std::vector<LayoutResult> full = runLayoutPages(escalated, boxScoreThresh, maxBatch);
+    for (size_t k = 0; k < escalatedIndex.size(); ++k) {
+        LayoutResult &fast = results[escalatedIndex[k]];
+        addFastTiming(fast, full[k]);
+        fast = std::move(full[k]);
+    }
+    return results;
 }
 
-LayoutResult LayoutNet::getLayoutBoxes(cv::Mat &src, float boxScoreThresh) {
+LayoutResult LayoutNet::runLayout(cv::Mat &src, float boxScoreThresh, int forcedInputSize,
+                                  RawOutput *raw) {
     LayoutResult result;
 
     if (!session) {
@@ -307,104 +690,188 @@ LayoutResult LayoutNet::getLayoutBoxes(cv::Mat &src, float boxScoreThresh) {
 
     // 开始计时
     auto startTime = std::chrono::high_resolution_clock::now();
+    StageTimer timer;
+    NetTiming &timing = result.timing.layoutNet;
 
     try {
-        // 预处理图像
-        cv::Mat inputImage = preprocessImage(src);
-
-        // 准备输入张量 - CHW格式
-        std::vector<int64_t> inputShape = {1, 3, INPUT_HEIGHT, INPUT_WIDTH};
-        std::vector<float> inputTensorData(3 * INPUT_HEIGHT * INPUT_WIDTH);
-
-        // HWC -> CHW 转换
-        for (int c = 0; c < 3; ++c) {
-            for (int h = 0; h < INPUT_HEIGHT; ++h) {
-                for (int w = 0; w < INPUT_WIDTH; ++w) {
-                    int srcIdx = (h * INPUT_WIDTH + w) * 3 + c;
-                    int dstIdx = c * INPUT_HEIGHT * INPUT_WIDTH + h * INPUT_WIDTH + w;
-                    inputTensorData[dstIdx] = inputImage.ptr<float>()[srcIdx];
-                }
-            }
+        // 预处理图像 - 直接写进绑定的CHW输入缓冲区
+        Letterbox letterbox = computeLetterbox(src.size(), resolveInputSize(src, forcedInputSize),
+                                               rectInput && dynamicInput);
+        result.inputSize = letterbox.inputSize;
+        float *inputTensorData = binding.inputBuffer({1, 3, letterbox.inputSize.height,
+                                                      letterbox.inputSize.width});
+        preprocessImage(src, letterbox, inputTensorData);
+
+        timer.lap(timing.preprocess, "LayoutNet::preprocess");
+
+        // 运行推理 - DOCLAYOUT_DOCSTRUCTBENCH 输入名 "images"，只取第一个输出
+        std::vector<int64_t> outputShape;
+        const float* outputData = binding.run(getRunOptions(netName, profiling, runCount),
+                                              outputShape);
+
+        timer.lap(timing.inference, "LayoutNet::inference");
+        LOGI("DOCLAYOUT_DOCSTRUCTBENCH inference completed, input=%s output=%s",
+             binding.inputName(), binding.outputName());
+        if (raw != nullptr) {
+            size_t count = 1;
+            for (int64_t dim : outputShape) count *= static_cast<size_t>(dim);
+            raw->src = src;
+            raw->letterbox = letterbox;
+            raw->shape = outputShape;
+            raw->data.assign(outputData, outputData + count);
+            raw->stage = LayoutStage::Full;
         }
 
-        // 创建输入张量
-        Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-        Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
-            memoryInfo, inputTensorData.data(), inputTensorData.size(),
-            inputShape.data(), inputShape.size());
+        decodeLayoutResult(src, outputData, outputShape, letterbox, boxScoreThresh, timer, result);
 
-        if (!inputTensor.IsTensor()) {
-            LOGI("ERROR: Failed to create input tensor!");
-            return result;
-        }
+        // 结束计时
+        auto endTime = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+        double processingTime = static_cast<double>(duration.count());
+        result.layoutNetTime = processingTime;
 
-        // 获取输入输出名称 - DOCLAYOUT_DOCSTRUCTBENCH 使用 "images" 作为输入名
-        Ort::AllocatorWithDefaultOptions allocator;
-        char* inputName = session->GetInputNameAllocated(0, allocator).release();
-        LOGI("Model input name: %s", inputName);
+        LOGI("DOCLAYOUT_DOCSTRUCTBENCH layout analysis completed successfully in %.2fms", processingTime);
 
-        size_t numOutputNodes = session->GetOutputCount();
-        std::vector<const char*> outputNames;
-        for (size_t i = 0; i < numOutputNodes; i++) {
-            char* outputName = session->GetOutputNameAllocated(i, allocator).release();
-            outputNames.push_back(outputName);
-        }
+    } catch (const std::exception& e) {
+        LOGI("Exception during layout analysis: %s", e.what());
+    }
 
-        // 运行推理
-        auto outputTensors = session->Run(Ort::RunOptions{nullptr},
-                                         &inputName, &inputTensor, 1,
-                                         outputNames.data(), numOutputNodes);
+    return result;
+}
 
-        // 释放名称内存
-        allocator.Free(const_cast<void*>(static_cast<const void*>(inputName)));
-        for (size_t i = 0; i < numOutputNodes; i++) {
-            allocator.Free(const_cast<void*>(static_cast<const void*>(outputNames[i])));
-        }
+void LayoutNet::decodeLayoutResult(cv::Mat &src, const float *outputData,
+                                   const std::vector<int64_t> &outputShape,
+                                   const Letterbox &letterbox, float boxScoreThresh,
+                                   StageTimer &timer, LayoutResult &result) {
+    NetTiming &timing = result.timing.layoutNet;
 
-        LOGI("DOCLAYOUT_DOCSTRUCTBENCH inference completed, got %zu output tensors", outputTensors.size());
+    // 解析输出 - 使用传入的置信度阈值
+    std::vector<LayoutBox> boxes = parseYOLOv8Output(outputData, outputShape, src, letterbox,
+                                                     boxScoreThresh);
 
-        // 解析输出
-        std::vector<LayoutBox> boxes;
-        if (outputTensors.size() >= 1) {
-            auto& outputTensor = outputTensors[0];
-            auto outputShapeInfo = outputTensor.GetTensorTypeAndShapeInfo();
-            std::vector<int64_t> outputShape = outputShapeInfo.GetShape();
+    timer.lap(timing.postprocess, "LayoutNet::parse");
 
-            float* outputData = outputTensor.GetTensorMutableData<float>();
+    // NMS过滤重叠框 - 与best_demo.py保持一致的IoU阈值
+    boxes = nmsBoxes(boxes, 0.4f);
+    timer.lap(timing.nms, "LayoutNet::nms");
 
-            // 使用传入的置信度阈值
-            float effectiveThreshold = boxScoreThresh;
-            boxes = parseYOLOv8Output(outputData, outputShape, src, effectiveThreshold);
-        }
+    LOGI("After NMS: %zu boxes remaining", boxes.size());
 
-        // NMS过滤重叠框 - 与best_demo.py保持一致的IoU阈值
-        boxes = nmsBoxes(boxes, 0.4f);
+    // 生成结果
+    result.layoutBoxes = std::move(boxes);
+    if (renderEnabled) renderLayoutResult(src, timer, result);
+}
 
-        LOGI("After NMS: %zu boxes remaining", boxes.size());
+void LayoutNet::renderLayoutResult(cv::Mat &src, StageTimer &timer, LayoutResult &result) {
+    result.layoutImg = src.clone();
 
-        // 结束计时
-        auto endTime = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
-        double processingTime = static_cast<double>(duration.count());
+    // 生成Markdown内容
+    result.markdown = generateLayoutMarkdown(result);
 
-        // 生成结果
-        result.layoutBoxes = boxes;
-        result.layoutImg = src.clone();
-        result.layoutNetTime = processingTime;
+    // 绘制检测结果
+    drawLayoutDetections(result.layoutImg, result.layoutBoxes);
+    timer.lap(result.timing.layoutNet.render, "LayoutNet::render");
+}
+
+std::vector<LayoutResult> LayoutNet::runLayoutPages(std::vector<cv::Mat> &pages,
+                                                    float boxScoreThresh, int maxBatch) {
+    std::vector<LayoutResult> results(pages.size());
+
+    if (!session) {
+        LOGI("Session not initialized");
+        return results;
+    }
+    if (!dynamicBatch) {
+        LOGW("LayoutNet model batch is fixed, running %zu pages one by one", pages.size());
+        for (size_t i = 0; i < pages.size(); ++i) {
+            if (!pages[i].empty()) results[i] = runLayout(pages[i], boxScoreThresh, 0);
+        }
+        return results;
+    }
 
-        // 生成Markdown内容
-        result.markdown = generateLayoutMarkdown(result);
+    // 按目标尺寸分组，同组页面的输入形状一致（rect模式在runLayoutBatch里统一补边）
+    const bool rect = rectInput && dynamicInput;
+    std::vector<Letterbox> letterboxes(pages.size());
+    std::map<int, std::vector<size_t>> groups;
+    for (size_t i = 0; i < pages.size(); ++i) {
+        if (pages[i].empty()) continue;
+        cv::Size targetSize = resolveInputSize(pages[i], 0);
+        letterboxes[i] = computeLetterbox(pages[i].size(), targetSize, rect);
+        groups[targetSize.width].push_back(i);
+    }
+
+    for (const auto &group : groups) {
+        const std::vector<size_t> &indices = group.second;
+        size_t chunk = static_cast<size_t>(maxBatch > 0 ? maxBatch : DEFAULT_MAX_BATCH);
+        for (size_t begin = 0; begin < indices.size(); begin += chunk) {
+            std::vector<size_t> batch(indices.begin() + begin,
+                                      indices.begin() + std::min(indices.size(), begin + chunk));
+            runLayoutBatch(pages, batch, letterboxes, boxScoreThresh, results);
+        }
+    }
+    // 多页的缓冲区不常驻，逐页推理最多用到一页最大档位的输入
+    binding.trimBuffers(3 * static_cast<size_t>(INPUT_WIDTH) * INPUT_HEIGHT);
+    return results;
+}
 
-        // 绘制检测结果
-        drawLayoutDetections(result.layoutImg, boxes);
+void LayoutNet::runLayoutBatch(std::vector<cv::Mat> &pages, const std::vector<size_t> &indices,
+                               std::vector<Letterbox> &letterboxes, float boxScoreThresh,
+                               std::vector<LayoutResult> &results) {
+    // rect模式下各页的宽高可能不同，统一补到组内最大值；正方形档位本来就相同
+    cv::Size batchSize(0, 0);
+    for (size_t i : indices) {
+        batchSize.width = std::max(batchSize.width, letterboxes[i].inputSize.width);
+        batchSize.height = std::max(batchSize.height, letterboxes[i].inputSize.height);
+    }
+    for (size_t i : indices) {
+        if (letterboxes[i].inputSize == batchSize) continue;
+        letterboxes[i].inputSize = batchSize;
+        centerPadding(letterboxes[i]);
+    }
 
-        LOGI("DOCLAYOUT_DOCSTRUCTBENCH layout analysis completed successfully in %.2fms", processingTime);
+    const int64_t batch = static_cast<int64_t>(indices.size());
+    const size_t pageInputSize = 3 * static_cast<size_t>(batchSize.area());
+    LOGI("LayoutNet batch: %d pages, input %dx%d", static_cast<int>(batch), batchSize.width,
+         batchSize.height);
 
+    StageTimer timer;
+    try {
+        float *inputTensorData = binding.inputBuffer({batch, 3, batchSize.height, batchSize.width});
+        for (size_t k = 0; k < indices.size(); ++k) {
+            size_t i = indices[k];
+            preprocessImage(pages[i], letterboxes[i], inputTensorData + k * pageInputSize);
+            results[i].inputSize = batchSize;
+            timer.lap(results[i].timing.layoutNet.preprocess, "LayoutNet::preprocess");
+        }
+
+        std::vector<int64_t> outputShape;
+        const float *outputData = binding.run(getRunOptions(netName, profiling, runCount),
+                                              outputShape);
+        StageTiming inference;
+        timer.lap(inference, "LayoutNet::inference");
+
+        if (outputShape.size() != 3 || outputShape[0] != batch) {
+            LOGE("LayoutNet batch output shape mismatch, expected [%d, det, 6]",
+                 static_cast<int>(batch));
+            return;
+        }
+        // 逐页解析：每页的输出是[det, 6]的连续一段
+        const std::vector<int64_t> pageShape = {1, outputShape[1], outputShape[2]};
+        const size_t pageOutputSize = static_cast<size_t>(outputShape[1] * outputShape[2]);
+        for (size_t k = 0; k < indices.size(); ++k) {
+            size_t i = indices[k];
+            NetTiming &timing = results[i].timing.layoutNet;
+            timing.inference.wallTime = inference.wallTime / batch;
+            timing.inference.cpuTime = inference.cpuTime / batch;
+            decodeLayoutResult(pages[i], outputData + k * pageOutputSize, pageShape,
+                               letterboxes[i], boxScoreThresh, timer, results[i]);
+            results[i].layoutNetTime = timing.preprocess.wallTime + timing.inference.wallTime +
+                                       timing.postprocess.wallTime + timing.nms.wallTime +
+                                       timing.render.wallTime;
+        }
     } catch (const std::exception& e) {
-        LOGI("Exception during layout analysis: %s", e.what());
+        LOGE("Exception during batched layout analysis: %s", e.what());
     }
-
-    return result;
 }
 
 std::vector<std::string> LayoutNet::getLayoutClassNames() {
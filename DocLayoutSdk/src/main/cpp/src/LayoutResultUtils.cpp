@@ -1,7 +1,9 @@
 #include <OcrUtils.h>
 #include "LayoutResultUtils.h"
+#include "OcrResultUtils.h"
 
 LayoutResultUtils::LayoutResultUtils(JNIEnv *env, LayoutResult &layoutResult, jobject layoutImg) {
+    StageTimer timer;
     jniEnv = env;
 
     jclass jLayoutResultClass = env->FindClass("com/benjaminwan/ocrlibrary/LayoutResult");
@@ -11,14 +13,18 @@ LayoutResultUtils::LayoutResultUtils(JNIEnv *env, LayoutResult &layoutResult, jo
     }
 
     jmethodID jLayoutResultConstructor = env->GetMethodID(jLayoutResultClass, "<init>",
-                                                           "(DLjava/util/ArrayList;Landroid/graphics/Bitmap;Ljava/lang/String;)V");
+                                                           "(DLjava/util/ArrayList;Landroid/graphics/Bitmap;Ljava/lang/String;Lcom/benjaminwan/ocrlibrary/PipelineTiming;I)V");
 
     jobject layoutBoxes = getLayoutBoxes(layoutResult.layoutBoxes);
     jdouble layoutNetTime = (jdouble) layoutResult.layoutNetTime;
     jstring jMarkdown = jniEnv->NewStringUTF(layoutResult.markdown.c_str());
+    // 耗时对象本身的构造不计入jniMarshal
+    timer.lap(layoutResult.timing.jniMarshal, "newLayoutResult");
+    jobject jTiming = newJPipelineTiming(env, layoutResult.timing);
 
     jLayoutResult = env->NewObject(jLayoutResultClass, jLayoutResultConstructor, layoutNetTime,
-                                    layoutBoxes, layoutImg, jMarkdown);
+                                    layoutBoxes, layoutImg, jMarkdown, jTiming,
+                                    static_cast<jint>(layoutResult.stage));
 }
 
 LayoutResultUtils::~LayoutResultUtils() {
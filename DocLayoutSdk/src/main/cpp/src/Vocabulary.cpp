@@ -0,0 +1,98 @@
+#include "Vocabulary.h"
+#include "OcrUtils.h"
+#include <cstring>
+
+static const char VOCAB_MAGIC[4] = {'O', 'C', 'R', 'V'};
+static const uint32_t VOCAB_VERSION = 1;
+static const size_t VOCAB_HEADER_SIZE = 12;
+
+static uint32_t readU32(const char *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+bool Vocabulary::load(ModelSource &&src) {
+    clear();
+    if (src.data() == nullptr) {
+        return false;
+    }
+    const char *data = (const char *) src.data();
+    if (src.size() >= VOCAB_HEADER_SIZE && memcmp(data, VOCAB_MAGIC, 4) == 0) {
+        source = std::move(src);
+        if (loadCompiled()) return true;
+        LOGE("invalid compiled vocabulary");
+        clear();
+        return false;
+    }
+    parseText(data, src.size());
+    src.release();
+    return true;
+}
+
+bool Vocabulary::loadCompiled() {
+    const char *data = (const char *) source.data();
+    size_t size = source.size();
+    uint32_t version = readU32(data + 4);
+    size_t n = readU32(data + 8);
+    if (version != VOCAB_VERSION || n == 0 || n >= (size - VOCAB_HEADER_SIZE) / 4) {
+        return false;
+    }
+    size_t offsetsEnd = VOCAB_HEADER_SIZE + (n + 1) * 4;
+    const char *offsetData = data + VOCAB_HEADER_SIZE;
+    bytes = data + offsetsEnd;
+    size_t bytesSize = size - offsetsEnd;
+    // 解码时直接按相邻offset之差取字节，损坏或截断的文件须在这里拒绝：
+    // 首项为0、单调不减、末项不超出字节区
+    if (readU32(offsetData) != 0 || readU32(offsetData + n * 4) > bytesSize) {
+        return false;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (readU32(offsetData + i * 4) > readU32(offsetData + (i + 1) * 4)) {
+            return false;
+        }
+    }
+    if ((uintptr_t) offsetData % alignof(uint32_t) == 0) {
+        offsets = (const uint32_t *) offsetData;
+    } else {
+        // asset未按4字节对齐时复制offsets，字节部分仍直接引用映射
+        ownedOffsets.resize(n + 1);
+        memcpy(ownedOffsets.data(), offsetData, (n + 1) * 4);
+        offsets = ownedOffsets.data();
+    }
+    count = n;
+    return true;
+}
+
+void Vocabulary::parseText(const char *text, size_t length) {
+    clear();
+    ownedBytes.reserve(length + 2);
+    ownedOffsets.reserve(length / 3 + 3);
+    // blank char for ctc
+    ownedOffsets.push_back(0);
+    ownedBytes.push_back('#');
+    const char *begin = text;
+    const char *end = text + length;
+    while (begin < end) {
+        ownedOffsets.push_back((uint32_t) ownedBytes.size());
+        const char *newline = (const char *) memchr(begin, '\n', end - begin);
+        const char *lineEnd = newline != nullptr ? newline : end;
+        ownedBytes.append(begin, lineEnd);
+        begin = newline != nullptr ? newline + 1 : end;
+    }
+    ownedOffsets.push_back((uint32_t) ownedBytes.size());
+    ownedBytes.push_back(' ');
+    ownedOffsets.push_back((uint32_t) ownedBytes.size());
+    offsets = ownedOffsets.data();
+    bytes = ownedBytes.data();
+    count = ownedOffsets.size() - 1;
+}
+
+void Vocabulary::clear() {
+    source.release();
+    ownedOffsets.clear();
+    ownedBytes.clear();
+    offsets = nullptr;
+    bytes = nullptr;
+    count = 0;
+}
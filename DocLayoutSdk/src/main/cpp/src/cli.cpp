@@ -0,0 +1,274 @@
+#include <getopt.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <opencv2/imgcodecs.hpp>
+#include "OcrLite.h"
+#include "OcrUtils.h"
+#include "OcrTrace.h"
+
+// 与 OcrEngine.kt 保持一致的默认模型与参数
+static const char *DEFAULT_DET_NAME = "ch_PP-OCRv3_det_infer.onnx";
+static const char *DEFAULT_CLS_NAME = "ch_ppocr_mobile_v2.0_cls_infer.onnx";
+static const char *DEFAULT_REC_NAME = "ch_PP-OCRv3_rec_infer.onnx";
+static const char *DEFAULT_KEYS_NAME = "ppocr_keys_v1.vocab";
+static const char *DEFAULT_LAYOUT_NAME = "doclayout_yolo_docstructbench_imgsz1024.onnx";
+
+static const struct option longOptions[] = {
+        {"models",            required_argument, NULL, 'd'},
+        {"det",               required_argument, NULL, '1'},
+        {"cls",               required_argument, NULL, '2'},
+        {"rec",               required_argument, NULL, '3'},
+        {"keys",              required_argument, NULL, '4'},
+        {"layoutModel",       required_argument, NULL, '5'},
+        {"layoutFastModel",   required_argument, NULL, '6'},
+        {"image",             required_argument, NULL, 'i'},
+        {"output",            required_argument, NULL, 'o'},
+        {"numThread",         required_argument, NULL, 't'},
+        {"padding",           required_argument, NULL, 'p'},
+        {"maxSideLen",        required_argument, NULL, 's'},
+        {"boxScoreThresh",    required_argument, NULL, 'b'},
+        {"boxThresh",         required_argument, NULL, 'B'},
+        {"unClipRatio",       required_argument, NULL, 'u'},
+        {"doAngle",           required_argument, NULL, 'a'},
+        {"mostAngle",         required_argument, NULL, 'A'},
+        {"layout",            no_argument,       NULL, 'l'},
+        {"layoutScoreThresh", required_argument, NULL, 'L'},
+        {"trace",             required_argument, NULL, 'T'},
+        {"profile",           required_argument, NULL, 'P'},
+        {"cacheDir",          required_argument, NULL, 'C'},
+        {"initMode",          required_argument, NULL, 'M'},
+        {"warmup",            no_argument,       NULL, 'W'},
+        {"layoutSize",        required_argument, NULL, 'S'},
+        {"layoutRect",        no_argument,       NULL, 'R'},
+        {"json",              required_argument, NULL, 'J'},
+        {"help",              no_argument,       NULL, 'h'},
+        {NULL,                no_argument,       NULL, 0}
+};
+
+static void printUsage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s --models DIR --image PATH [options]\n"
+            "  -d, --models DIR             models directory\n"
+            "      --det/--cls/--rec/--keys/--layoutModel NAME\n"
+            "                               model file names inside DIR\n"
+            "      --layoutFastModel NAME   small layout model run first; the full model only runs\n"
+            "                               when its result fails the cascade gates\n"
+            "  -i, --image PATH             input image\n"
+            "  -o, --output PATH            write the annotated image\n"
+            "  -t, --numThread N            threads per net (default 4)\n"
+            "  -p, --padding N              (default 50)\n"
+            "  -s, --maxSideLen N           0 = original size (default 0)\n"
+            "  -b, --boxScoreThresh F       (default 0.3)\n"
+            "  -B, --boxThresh F            (default 0.15)\n"
+            "  -u, --unClipRatio F          (default 1.6)\n"
+            "  -a, --doAngle 0|1            (default 1)\n"
+            "  -A, --mostAngle 0|1          (default 1)\n"
+            "  -l, --layout                 run layout analysis instead of OCR\n"
+            "  -L, --layoutScoreThresh F    (default 0.1)\n"
+            "  -T, --trace PATH             write a Chrome trace-event JSON of the run\n"
+            "  -P, --profile PREFIX         enable ONNX Runtime operator profiling per net\n"
+            "  -C, --cacheDir DIR           cache optimized models (ORT format) in DIR\n"
+            "  -M, --initMode MODE          eager|background|lazy (default eager)\n"
+            "  -W, --warmup                 warm every net up at the configured shapes after init\n"
+            "  -S, --layoutSize N           layout input side 640|800|1024..., 0 = auto by page (default 1024)\n"
+            "  -R, --layoutRect             pad the layout input only to a stride-32 multiple, e.g. 736x1024\n"
+            "  -J, --json PATH              with --layout, write the boxes as JSON (scripts/compare_layout.py)\n",
+            argv0);
+}
+
+static std::string joinPath(const std::string &dir, const std::string &name) {
+    if (dir.empty() || name.empty() || name[0] == '/') return name;
+    if (dir.back() == '/') return dir + name;
+    return dir + "/" + name;
+}
+
+static void printNetTiming(const char *name, const NetTiming &timing) {
+    const char *stageNames[] = {"preprocess", "inference", "postprocess", "nms", "crop", "render"};
+    const StageTiming *stages[] = {&timing.preprocess, &timing.inference, &timing.postprocess,
+                                   &timing.nms, &timing.crop, &timing.render};
+    for (int i = 0; i < 6; ++i) {
+        if (stages[i]->wallTime <= 0) continue;
+        fprintf(stderr, "  %-10s %-12s wall(%9.3fms) cpu(%9.3fms)\n", name, stageNames[i],
+                stages[i]->wallTime, stages[i]->cpuTime);
+    }
+}
+
+// 与best_demo_python_standard.py --json 相同的格式
+static const char *LAYOUT_STAGE_NAMES[] = {"full", "fast", "escalated"};
+
+static bool writeLayoutJson(const std::string &path, const LayoutResult &result) {
+    FILE *fp = fopen(path.c_str(), "w");
+    if (fp == NULL) return false;
+    fprintf(fp, "{\"input\": [%d, %d], \"stage\": \"%s\", \"boxes\": [", result.inputSize.width,
+            result.inputSize.height, LAYOUT_STAGE_NAMES[static_cast<int>(result.stage)]);
+    for (size_t i = 0; i < result.layoutBoxes.size(); ++i) {
+        const LayoutBox &box = result.layoutBoxes[i];
+        fprintf(fp, "%s{\"class_id\": %d, \"score\": %.6f, \"bbox\": [%d, %d, %d, %d]}",
+                i > 0 ? ", " : "", static_cast<int>(box.type), box.score, box.boxPoint[0].x,
+                box.boxPoint[0].y, box.boxPoint[2].x, box.boxPoint[2].y);
+    }
+    fprintf(fp, "]}\n");
+    fclose(fp);
+    return true;
+}
+
+static void printTiming(const PipelineTiming &timing) {
+    fprintf(stderr, "timing:\n");
+    printNetTiming("layoutNet", timing.layoutNet);
+    printNetTiming("dbNet", timing.dbNet);
+    printNetTiming("angleNet", timing.angleNet);
+    printNetTiming("crnnNet", timing.crnnNet);
+}
+
+int main(int argc, char **argv) {
+    std::string modelsDir = ".";
+    std::string detName = DEFAULT_DET_NAME;
+    std::string clsName = DEFAULT_CLS_NAME;
+    std::string recName = DEFAULT_REC_NAME;
+    std::string keysName = DEFAULT_KEYS_NAME;
+    std::string layoutName = DEFAULT_LAYOUT_NAME;
+    std::string layoutFastName;
+    std::string imagePath, outputPath;
+    int numThread = 4;
+    int padding = 50;
+    int maxSideLen = 0;
+    float boxScoreThresh = 0.3f;
+    float boxThresh = 0.15f;
+    float unClipRatio = 1.6f;
+    bool doAngle = true;
+    bool mostAngle = true;
+    bool layout = false;
+    float layoutScoreThresh = 0.1f;
+    std::string tracePath;
+    std::string profilePrefix;
+    std::string cacheDir;
+    InitMode initMode = InitMode::Eager;
+    bool warmup = false;
+    int layoutSize = -1;
+    bool layoutRect = false;
+    std::string jsonPath;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "d:i:o:t:p:s:b:B:u:a:A:lL:T:P:C:M:WS:RJ:h", longOptions, NULL)) != -1) {
+        switch (opt) {
+            case 'd': modelsDir = optarg; break;
+            case '1': detName = optarg; break;
+            case '2': clsName = optarg; break;
+            case '3': recName = optarg; break;
+            case '4': keysName = optarg; break;
+            case '5': layoutName = optarg; break;
+            case '6': layoutFastName = optarg; break;
+            case 'i': imagePath = optarg; break;
+            case 'o': outputPath = optarg; break;
+            case 't': numThread = atoi(optarg); break;
+            case 'p': padding = atoi(optarg); break;
+            case 's': maxSideLen = atoi(optarg); break;
+            case 'b': boxScoreThresh = strtof(optarg, NULL); break;
+            case 'B': boxThresh = strtof(optarg, NULL); break;
+            case 'u': unClipRatio = strtof(optarg, NULL); break;
+            case 'a': doAngle = atoi(optarg) != 0; break;
+            case 'A': mostAngle = atoi(optarg) != 0; break;
+            case 'l': layout = true; break;
+            case 'L': layoutScoreThresh = strtof(optarg, NULL); break;
+            case 'T': tracePath = optarg; break;
+            case 'P': profilePrefix = optarg; break;
+            case 'C': cacheDir = optarg; break;
+            case 'M':
+                if (strcmp(optarg, "background") == 0) initMode = InitMode::Background;
+                else if (strcmp(optarg, "lazy") == 0) initMode = InitMode::Lazy;
+                else initMode = InitMode::Eager;
+                break;
+            case 'W': warmup = true; break;
+            case 'S': layoutSize = atoi(optarg); break;
+            case 'R': layoutRect = true; break;
+            case 'J': jsonPath = optarg; break;
+            case 'h':
+            default:
+                printUsage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (imagePath.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    cv::Mat imgBGR = cv::imread(imagePath, cv::IMREAD_COLOR);
+    if (imgBGR.empty()) {
+        LOGE("cannot read image: %s", imagePath.c_str());
+        return 1;
+    }
+
+    OcrLite ocrLite;
+    ocrLite.setProfilePrefix(profilePrefix);
+    ocrLite.setCacheDir(cacheDir);
+    ocrLite.setInitMode(initMode);
+    if (layoutSize >= 0) ocrLite.setLayoutInputSize(layoutSize);
+    ocrLite.setLayoutRectInput(layoutRect);
+    if (!layoutFastName.empty()) ocrLite.setLayoutCascade(joinPath(modelsDir, layoutFastName));
+    if (warmup) {
+        WarmupConfig warmupConfig;
+        warmupConfig.enabled = true;
+        if (maxSideLen > 0) warmupConfig.dbSideLen = maxSideLen + 2 * padding;
+        ocrLite.setWarmup(warmupConfig);
+    }
+    try {
+        ocrLite.init(numThread,
+                     joinPath(modelsDir, detName), joinPath(modelsDir, clsName),
+                     joinPath(modelsDir, recName), joinPath(modelsDir, keysName),
+                     joinPath(modelsDir, layoutName));
+    } catch (const std::exception &e) {
+        LOGE("init failed: %s", e.what());
+        return 1;
+    }
+
+    if (!tracePath.empty()) OcrTrace::start();
+    cv::Mat outImg;
+    try {
+        // background/lazy模式下网络在这里才等待/创建，失败时同样抛出
+        if (layout) {
+            LayoutResult layoutResult = ocrLite.detectLayout(imgBGR, layoutScoreThresh);
+            printf("%s\n", layoutResult.markdown.c_str());
+            fprintf(stderr, "layoutNetTime(%fms) input(%dx%d) stage(%s)\n", layoutResult.layoutNetTime,
+                    layoutResult.inputSize.width, layoutResult.inputSize.height,
+                    LAYOUT_STAGE_NAMES[static_cast<int>(layoutResult.stage)]);
+            printTiming(layoutResult.timing);
+            if (!jsonPath.empty() && !writeLayoutJson(jsonPath, layoutResult)) {
+                LOGE("cannot write %s", jsonPath.c_str());
+            }
+            outImg = layoutResult.layoutImg;
+        } else {
+            OcrResult ocrResult = ocrLite.detect(imgBGR, padding, maxSideLen, boxScoreThresh,
+                                                 boxThresh, unClipRatio, doAngle, mostAngle);
+            printf("%s", ocrResult.strRes.c_str());
+            fprintf(stderr, "dbNetTime(%fms) detectTime(%fms)\n", ocrResult.dbNetTime,
+                    ocrResult.detectTime);
+            printTiming(ocrResult.timing);
+            outImg = ocrResult.boxImg;
+        }
+    } catch (const std::exception &e) {
+        LOGE("init failed: %s", e.what());
+        return 1;
+    }
+
+    for (const auto &timing : ocrLite.getInitTiming()) {
+        fprintf(stderr, "init: %s\n", formatInitTiming(timing).c_str());
+    }
+    for (const auto &info : ocrLite.getNetMemory()) {
+        fprintf(stderr, "memory: %s\n", formatNetMemory(info).c_str());
+    }
+    for (const auto &file : ocrLite.endProfiling()) {
+        fprintf(stderr, "profile: %s\n", file.c_str());
+    }
+    if (!tracePath.empty()) {
+        OcrTrace::stop();
+        OcrTrace::writeJson(tracePath);
+    }
+
+    if (!outputPath.empty() && !outImg.empty()) {
+        cv::imwrite(outputPath, outImg);
+    }
+    return 0;
+}
@@ -3,6 +3,7 @@
 #include "BitmapUtils.h"
 #include "OcrLite.h"
 #include "OcrUtils.h"
+#include "OcrTrace.h"
 
 static OcrLite *ocrLite;
 
@@ -30,13 +31,58 @@ Java_com_benjaminwan_ocrlibrary_OcrEngine_init(JNIEnv *env, jobject thiz, jobjec
     return JNI_TRUE;
 }
 
-cv::Mat makePadding(cv::Mat &src, const int padding) {
-    if (padding <= 0) return src;
-    cv::Scalar paddingScalar = {255, 255, 255};
-    cv::Mat paddingSrc;
-    cv::copyMakeBorder(src, paddingSrc, padding, padding, padding, padding, cv::BORDER_ISOLATED,
-                       paddingScalar);
-    return paddingSrc;
+// boxImg/layoutImg写回output并打包成Java对象
+static jobject ocrResultToJObject(JNIEnv *env, OcrResult &ocrResult, jobject output,
+                                  StageTiming &marshalTiming) {
+    StageTimer timer;
+    cv::Mat imgOut;
+    cv::cvtColor(ocrResult.boxImg, imgOut, cv::COLOR_BGR2RGBA);
+    matToBitmap(env, imgOut, output);
+    timer.lap(marshalTiming, "matToBitmap");
+    ocrResult.timing.jniMarshal += marshalTiming;
+    return OcrResultUtils(env, ocrResult, output).getJObject();
+}
+
+static jobject layoutResultToJObject(JNIEnv *env, LayoutResult &layoutResult, jobject output,
+                                     StageTiming &marshalTiming) {
+    StageTimer timer;
+    cv::Mat imgOut;
+    cv::cvtColor(layoutResult.layoutImg, imgOut, cv::COLOR_BGR2RGBA);
+    matToBitmap(env, imgOut, output);
+    timer.lap(marshalTiming, "matToBitmap");
+    layoutResult.timing.jniMarshal += marshalTiming;
+    return LayoutResultUtils(env, layoutResult, output).getJObject();
+}
+
+static jobject detectBitmap(JNIEnv *env, jobject input, jobject output, jint handle, jint padding,
+                            jint maxSideLen, jfloat boxScoreThresh, jfloat boxThresh,
+                            jfloat unClipRatio, jboolean doAngle, jboolean mostAngle) {
+    Logger("handle(%d),padding(%d),maxSideLen(%d),boxScoreThresh(%f),boxThresh(%f),unClipRatio(%f),doAngle(%d),mostAngle(%d)",
+           handle, padding, maxSideLen, boxScoreThresh, boxThresh, unClipRatio, doAngle, mostAngle);
+    TraceSpan span("JNI::detect");
+    StageTimer timer;
+    StageTiming marshalTiming;
+    cv::Mat imgRGBA, imgBGR;
+    bitmapToMat(env, input, imgRGBA);
+    cv::cvtColor(imgRGBA, imgBGR, cv::COLOR_RGBA2BGR);
+    timer.lap(marshalTiming, "bitmapToMat");
+    OcrResult ocrResult = ocrLite->detect(imgBGR, padding, maxSideLen, boxScoreThresh, boxThresh,
+                                          unClipRatio, doAngle, mostAngle, handle);
+    return ocrResultToJObject(env, ocrResult, output, marshalTiming);
+}
+
+static jobject detectLayoutBitmap(JNIEnv *env, jobject input, jobject output, jint handle,
+                                  jfloat boxScoreThresh) {
+    Logger("detectLayout,handle(%d),boxScoreThresh(%f)", handle, boxScoreThresh);
+    TraceSpan span("JNI::detectLayout");
+    StageTimer timer;
+    StageTiming marshalTiming;
+    cv::Mat imgRGBA, imgBGR;
+    bitmapToMat(env, input, imgRGBA);
+    cv::cvtColor(imgRGBA, imgBGR, cv::COLOR_RGBA2BGR);
+    timer.lap(marshalTiming, "bitmapToMat");
+    LayoutResult layoutResult = ocrLite->detectLayout(imgBGR, boxScoreThresh, handle);
+    return layoutResultToJObject(env, layoutResult, output, marshalTiming);
 }
 
 extern "C"
@@ -44,30 +90,35 @@ JNIEXPORT jobject JNICALL
 Java_com_benjaminwan_ocrlibrary_OcrEngine_detect(JNIEnv *env, jobject thiz, jobject input, jobject output,
                                                  jint padding, jint maxSideLen, jfloat boxScoreThresh, jfloat boxThresh,
                                                  jfloat unClipRatio, jboolean doAngle, jboolean mostAngle) {
-    Logger("padding(%d),maxSideLen(%d),boxScoreThresh(%f),boxThresh(%f),unClipRatio(%f),doAngle(%d),mostAngle(%d)",
-           padding, maxSideLen, boxScoreThresh, boxThresh, unClipRatio, doAngle, mostAngle);
-    cv::Mat imgRGBA, imgBGR, imgOut;
-    bitmapToMat(env, input, imgRGBA);
-    cv::cvtColor(imgRGBA, imgBGR, cv::COLOR_RGBA2BGR);
-    int originMaxSide = (std::max)(imgBGR.cols, imgBGR.rows);
-    int resize;
-    if (maxSideLen <= 0 || maxSideLen > originMaxSide) {
-        resize = originMaxSide;
-    } else {
-        resize = maxSideLen;
-    }
-    resize += 2*padding;
-    cv::Rect paddingRect(padding, padding, imgBGR.cols, imgBGR.rows);
-    cv::Mat paddingSrc = makePadding(imgBGR, padding);
-    //按比例缩小图像，减少文字分割时间
-    ScaleParam s = getScaleParam(paddingSrc, resize);//例：按长或宽缩放 src.cols=不缩放，src.cols/2=长度缩小一半
-    OcrResult ocrResult = ocrLite->detect(paddingSrc, paddingRect, s, boxScoreThresh, boxThresh,
-                                          unClipRatio, doAngle, mostAngle);
+    return detectBitmap(env, input, output, -1, padding, maxSideLen, boxScoreThresh, boxThresh,
+                        unClipRatio, doAngle, mostAngle);
+}
 
-    cv::cvtColor(ocrResult.boxImg, imgOut, cv::COLOR_BGR2RGBA);
-    matToBitmap(env, imgOut, output);
+extern "C"
+JNIEXPORT jobject JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_detectPage(JNIEnv *env, jobject thiz, jint handle,
+                                                     jobject input, jobject output, jint padding,
+                                                     jint maxSideLen, jfloat boxScoreThresh,
+                                                     jfloat boxThresh, jfloat unClipRatio,
+                                                     jboolean doAngle, jboolean mostAngle) {
+    return detectBitmap(env, input, output, handle, padding, maxSideLen, boxScoreThresh, boxThresh,
+                        unClipRatio, doAngle, mostAngle);
+}
 
-    return OcrResultUtils(env, ocrResult, output).getJObject();
+extern "C"
+JNIEXPORT jobject JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_refilter(JNIEnv *env, jobject thiz, jint handle,
+                                                   jobject output, jfloat boxScoreThresh,
+                                                   jfloat boxThresh, jfloat unClipRatio,
+                                                   jboolean doAngle, jboolean mostAngle) {
+    Logger("refilter,handle(%d),boxScoreThresh(%f),boxThresh(%f),unClipRatio(%f)", handle,
+           boxScoreThresh, boxThresh, unClipRatio);
+    TraceSpan span("JNI::refilter");
+    StageTiming marshalTiming;
+    OcrResult ocrResult = ocrLite->refilter(handle, boxScoreThresh, boxThresh, unClipRatio,
+                                            doAngle, mostAngle);
+    if (ocrResult.boxImg.empty()) return NULL;
+    return ocrResultToJObject(env, ocrResult, output, marshalTiming);
 }
 
 extern "C" JNIEXPORT jdouble JNICALL
@@ -116,15 +167,161 @@ extern "C"
 JNIEXPORT jobject JNICALL
 Java_com_benjaminwan_ocrlibrary_OcrEngine_detectLayout(JNIEnv *env, jobject thiz, jobject input, jobject output,
                                                         jfloat boxScoreThresh) {
-    Logger("detectLayout,boxScoreThresh(%f)", boxScoreThresh);
-    cv::Mat imgRGBA, imgBGR, imgOut;
-    bitmapToMat(env, input, imgRGBA);
-    cv::cvtColor(imgRGBA, imgBGR, cv::COLOR_RGBA2BGR);
+    return detectLayoutBitmap(env, input, output, -1, boxScoreThresh);
+}
+
+extern "C"
+JNIEXPORT jobject JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_detectLayoutPage(JNIEnv *env, jobject thiz, jint handle,
+                                                            jobject input, jobject output,
+                                                            jfloat boxScoreThresh) {
+    return detectLayoutBitmap(env, input, output, handle, boxScoreThresh);
+}
 
-    LayoutResult layoutResult = ocrLite->detectLayout(imgBGR, boxScoreThresh);
+extern "C"
+JNIEXPORT jobject JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_refilterLayout(JNIEnv *env, jobject thiz, jint handle,
+                                                          jobject output, jfloat boxScoreThresh) {
+    Logger("refilterLayout,handle(%d),boxScoreThresh(%f)", handle, boxScoreThresh);
+    TraceSpan span("JNI::refilterLayout");
+    StageTiming marshalTiming;
+    LayoutResult layoutResult = ocrLite->refilterLayout(handle, boxScoreThresh);
+    if (layoutResult.layoutImg.empty()) return NULL;
+    return layoutResultToJObject(env, layoutResult, output, marshalTiming);
+}
 
-    cv::cvtColor(layoutResult.layoutImg, imgOut, cv::COLOR_BGR2RGBA);
-    matToBitmap(env, imgOut, output);
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_setRefilterCache(JNIEnv *env, jobject thiz, jint pages) {
+    ocrLite->setRefilterCache(pages);
+}
 
-    return LayoutResultUtils(env, layoutResult, output).getJObject();
-}
\ No newline at end of file
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_releasePage(JNIEnv *env, jobject thiz, jint handle) {
+    ocrLite->releasePage(handle);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_setInitMode(JNIEnv *env, jobject thiz, jint mode) {
+    ocrLite->setInitMode(static_cast<InitMode>(mode));
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_setWarmup(JNIEnv *env, jobject thiz, jboolean enabled,
+                                                     jint dbSideLen, jintArray crnnWidths) {
+    WarmupConfig config;
+    config.enabled = enabled;
+    config.dbSideLen = dbSideLen;
+    jsize count = env->GetArrayLength(crnnWidths);
+    config.crnnWidths.resize(count);
+    env->GetIntArrayRegion(crnnWidths, 0, count, config.crnnWidths.data());
+    ocrLite->setWarmup(config);
+}
+
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_getInitTiming(JNIEnv *env, jobject thiz) {
+    std::vector<NetInitTiming> timings = ocrLite->getInitTiming();
+    jclass stringClass = env->FindClass("java/lang/String");
+    jobjectArray jTimings = env->NewObjectArray(timings.size(), stringClass, NULL);
+    for (int i = 0; i < timings.size(); ++i) {
+        env->SetObjectArrayElement(jTimings, i, env->NewStringUTF(formatInitTiming(timings[i]).c_str()));
+    }
+    return jTimings;
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_isOcrReady(JNIEnv *env, jobject thiz) {
+    return ocrLite->isOcrReady() ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_isLayoutReady(JNIEnv *env, jobject thiz) {
+    return ocrLite->isLayoutReady() ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_setIdleTimeout(JNIEnv *env, jobject thiz, jfloat seconds) {
+    ocrLite->setIdleTimeout(seconds);
+}
+
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_getNetMemory(JNIEnv *env, jobject thiz) {
+    std::vector<NetMemoryInfo> infos = ocrLite->getNetMemory();
+    jclass stringClass = env->FindClass("java/lang/String");
+    jobjectArray jInfos = env->NewObjectArray(infos.size(), stringClass, NULL);
+    for (int i = 0; i < infos.size(); ++i) {
+        env->SetObjectArrayElement(jInfos, i, env->NewStringUTF(formatNetMemory(infos[i]).c_str()));
+    }
+    return jInfos;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_setLayoutInputSize(JNIEnv *env, jobject thiz, jint size) {
+    ocrLite->setLayoutInputSize(size);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_setLayoutRectInput(JNIEnv *env, jobject thiz, jboolean enabled) {
+    ocrLite->setLayoutRectInput(enabled);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_setLayoutCascade(JNIEnv *env, jobject thiz, jstring fastName,
+                                                            jint fastInputSize, jfloat minMeanScore,
+                                                            jfloat minInkCoverage,
+                                                            jboolean escalateComplex) {
+    LayoutCascadeConfig config;
+    config.fastInputSize = fastInputSize;
+    config.minMeanScore = minMeanScore;
+    config.minInkCoverage = minInkCoverage;
+    config.escalateComplex = escalateComplex;
+    ocrLite->setLayoutCascade(jstringTostring(env, fastName), config);
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_setCacheDir(JNIEnv *env, jobject thiz, jstring dir) {
+    ocrLite->setCacheDir(jstringTostring(env, dir));
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_setProfilePrefix(JNIEnv *env, jobject thiz, jstring prefix) {
+    ocrLite->setProfilePrefix(jstringTostring(env, prefix));
+}
+
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_endProfiling(JNIEnv *env, jobject thiz) {
+    std::vector<std::string> files = ocrLite->endProfiling();
+    jclass stringClass = env->FindClass("java/lang/String");
+    jobjectArray jFiles = env->NewObjectArray(files.size(), stringClass, NULL);
+    for (int i = 0; i < files.size(); ++i) {
+        env->SetObjectArrayElement(jFiles, i, env->NewStringUTF(files[i].c_str()));
+    }
+    return jFiles;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_startTrace(JNIEnv *env, jobject thiz) {
+    OcrTrace::start();
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_benjaminwan_ocrlibrary_OcrEngine_stopTrace(JNIEnv *env, jobject thiz, jstring path) {
+    OcrTrace::stop();
+    return OcrTrace::writeJson(jstringTostring(env, path)) ? JNI_TRUE : JNI_FALSE;
+}
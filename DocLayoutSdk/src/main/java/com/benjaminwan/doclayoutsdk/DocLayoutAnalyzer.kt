@@ -254,10 +254,9 @@ class DocLayoutAnalyzer private constructor(context: Context) {
 
         val markdown = generateMarkdown(updatedLayoutBoxes, figureResults)
 
-        LayoutResult(
-            layoutNetTime = layoutResult.layoutNetTime,
+        // copy保留stage、timing等其余字段
+        layoutResult.copy(
             layoutBoxes = ArrayList(updatedLayoutBoxes),
-            layoutImg = layoutResult.layoutImg,
             markdown = markdown
         )
     }
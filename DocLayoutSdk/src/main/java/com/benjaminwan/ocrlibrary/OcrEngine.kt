@@ -3,20 +3,54 @@ package com.benjaminwan.ocrlibrary
 import android.content.Context
 import android.content.res.AssetManager
 import android.graphics.Bitmap
+import java.io.File
 
-class OcrEngine(context: Context) {
+// 四个模型的创建方式，顺序与native InitMode一致
+enum class InitMode {
+    EAGER,      // 并行创建全部模型，构造函数在全部完成后返回
+    BACKGROUND, // 后台并行创建，构造函数立即返回；detect/detectLayout只等待各自需要的模型
+    LAZY        // 第一次用到某个模型时才创建
+}
+
+// 版面两级级联：fastModel（assets里的小模型）先分析，平均置信度、墨迹覆盖率不达标或检测到图片/表格/公式时
+// 再跑完整版面模型，LayoutResult.stage记录结果来自哪一级
+data class LayoutCascade(
+    val fastModel: String,
+    val fastInputSize: Int = 640,
+    val minMeanScore: Float = 0.5f,
+    val minInkCoverage: Float = 0.9f,
+    val escalateComplex: Boolean = true
+)
+
+// profilePrefix非空时开启ORT算子级profiling，文件写到 profilePrefix_det/cls/rec/layout_*.json
+// warmup为true时模型创建后用空白输入预热一次，首个请求不再慢；配合BACKGROUND时在后台完成
+class OcrEngine(
+    context: Context,
+    profilePrefix: String = "",
+    initMode: InitMode = InitMode.EAGER,
+    warmup: Boolean = false,
+    layoutCascade: LayoutCascade? = null
+) {
     companion object {
         const val numThread: Int = 4
     }
 
     init {
         System.loadLibrary("RapidOcr")
+        if (profilePrefix.isNotEmpty()) setProfilePrefix(profilePrefix)
+        // 图优化结果缓存在codeCacheDir，应用升级时系统会清空，正好对应模型/ORT版本变化
+        setCacheDir(File(context.codeCacheDir, "ort").absolutePath)
+        setInitMode(initMode.ordinal)
+        if (warmup) setWarmup(true, 1024 + 2 * 50, intArrayOf(160, 320, 640, 960))
+        layoutCascade?.let {
+            setLayoutCascade(it.fastModel, it.fastInputSize, it.minMeanScore, it.minInkCoverage, it.escalateComplex)
+        }
         val ret = init(
             context.assets, numThread,
             "ch_PP-OCRv3_det_infer.onnx",
             "ch_ppocr_mobile_v2.0_cls_infer.onnx",
             "ch_PP-OCRv3_rec_infer.onnx",
-            "ppocr_keys_v1.txt",
+            "ppocr_keys_v1.vocab",
             "doclayout_yolo_docstructbench_imgsz1024.onnx"
         )
         if (!ret) throw IllegalArgumentException()
@@ -56,6 +90,76 @@ class OcrEngine(context: Context) {
     // 版面分析相关方法
     external fun detectLayout(input: Bitmap, output: Bitmap, boxScoreThresh: Float): LayoutResult
 
+    // 换阈值不重跑推理：setRefilterCache(n)后用detectPage/detectLayoutPage检测并以handle缓存模型输出，
+    // 之后refilter/refilterLayout按新阈值只重做后处理（输出图须与原图同尺寸），没有缓存时返回null。
+    // 缓存最多n页，超出丢弃最久未用的；0关闭（默认）
+    external fun setRefilterCache(pages: Int)
+
+    external fun detectPage(
+        handle: Int, input: Bitmap, output: Bitmap, padding: Int, maxSideLen: Int,
+        boxScoreThresh: Float, boxThresh: Float,
+        unClipRatio: Float, doAngle: Boolean, mostAngle: Boolean
+    ): OcrResult
+
+    external fun detectLayoutPage(handle: Int, input: Bitmap, output: Bitmap, boxScoreThresh: Float): LayoutResult
+
+    // 几何没变的文本框沿用缓存的方向与文字，只有新出现的框才跑方向/识别模型
+    external fun refilter(
+        handle: Int, output: Bitmap, boxScoreThresh: Float, boxThresh: Float,
+        unClipRatio: Float, doAngle: Boolean, mostAngle: Boolean
+    ): OcrResult?
+
+    external fun refilterLayout(handle: Int, output: Bitmap, boxScoreThresh: Float): LayoutResult?
+
+    external fun releasePage(handle: Int)
+
+    external fun setInitMode(mode: Int)
+
+    // dbSideLen为DbNet输入长边（maxSideLen + 2*padding），crnnWidths为识别模型预热的行宽
+    external fun setWarmup(enabled: Boolean, dbSideLen: Int, crnnWidths: IntArray)
+
+    // 每个模型一行：创建耗时、预热耗时、从init开始到可用的时间
+    external fun getInitTiming(): Array<String>
+
+    // detect所需的检测/方向/识别模型是否都已创建完成
+    external fun isOcrReady(): Boolean
+
+    // detectLayout所需的版面模型是否已创建完成
+    external fun isLayoutReady(): Boolean
+
+    // 模型空闲超过seconds秒即释放，下次调用时自动重新创建；<=0关闭（默认）
+    external fun setIdleTimeout(seconds: Float)
+
+    // 每个模型一行：状态、模型大小、创建/首次推理的内存增量（RSS近似）、创建次数、空闲时长
+    external fun getNetMemory(): Array<String>
+
+    // 版面模型输入边长（640/800/1024等32的倍数），0为按页面尺寸和内容密度自动选档；
+    // 只对导出为动态输入的版面模型生效，默认1024
+    external fun setLayoutInputSize(size: Int)
+
+    // 版面模型输入只把短边补到32的倍数（A4竖版1024×736），省掉约28%的计算；只对动态输入的版面模型生效
+    external fun setLayoutRectInput(enabled: Boolean)
+
+    // 版面两级级联，须在init之前调用；fastName为空关闭，见LayoutCascade
+    external fun setLayoutCascade(
+        fastName: String, fastInputSize: Int, minMeanScore: Float,
+        minInkCoverage: Float, escalateComplex: Boolean
+    )
+
+    // 优化后模型的缓存目录，须在init之前调用；空字符串关闭缓存
+    external fun setCacheDir(dir: String)
+
+    external fun setProfilePrefix(prefix: String)
+
+    // 结束ORT profiling，返回写出的profile文件路径
+    external fun endProfiling(): Array<String>
+
+    // 开始记录流水线span（清空之前的记录）
+    external fun startTrace()
+
+    // 停止记录并把Chrome trace-event JSON写到path，可用 ui.perfetto.dev 打开
+    external fun stopTrace(path: String): Boolean
+
     fun detectLayoutWithDefaultThreshold(input: Bitmap, output: Bitmap, boxScoreThresh: Float = layoutScoreThresh): LayoutResult =
         detectLayout(input, output, boxScoreThresh)
 
@@ -0,0 +1,68 @@
+#ifndef __OCR_BENCH_UTILS_H__
+#define __OCR_BENCH_UTILS_H__
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct BenchStats {
+    int count;
+    double mean;
+    double min;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+};
+
+inline double benchNowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+// nearest-rank 百分位，samples 必须已排序
+inline double benchPercentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = (size_t) std::ceil(p / 100.0 * (double) sorted.size());
+    rank = std::min(std::max(rank, (size_t) 1), sorted.size());
+    return sorted[rank - 1];
+}
+
+inline BenchStats benchComputeStats(std::vector<double> samples) {
+    BenchStats stats{};
+    stats.count = (int) samples.size();
+    if (samples.empty()) return stats;
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double s : samples) sum += s;
+    stats.mean = sum / (double) samples.size();
+    stats.min = samples.front();
+    stats.p50 = benchPercentile(samples, 50);
+    stats.p90 = benchPercentile(samples, 90);
+    stats.p99 = benchPercentile(samples, 99);
+    stats.max = samples.back();
+    return stats;
+}
+
+// 至少跑 minIters 次，并一直跑到累计 minTimeMs 或达到 maxIters
+inline std::vector<double> benchRun(const std::function<void()> &fn, int warmup, int minIters,
+                                    int maxIters, double minTimeMs) {
+    for (int i = 0; i < warmup; ++i) fn();
+    std::vector<double> samples;
+    double total = 0.0;
+    while ((int) samples.size() < maxIters &&
+           ((int) samples.size() < minIters || total < minTimeMs)) {
+        double start = benchNowMs();
+        fn();
+        double elapsed = benchNowMs() - start;
+        samples.push_back(elapsed);
+        total += elapsed;
+    }
+    return samples;
+}
+
+#endif //__OCR_BENCH_UTILS_H__
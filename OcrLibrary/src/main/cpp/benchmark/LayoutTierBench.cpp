@@ -0,0 +1,217 @@
+// 版面输入档位基准：对目录下每一页分别以各档位（及自动选档）运行LayoutNet，
+// 记录延迟，并以1024档的结果为参照统计同类框IoU>=0.5的召回率/精确率（没有人工标注时衡量降档的精度损失）。
+// 只对导出为动态输入的版面模型有意义；输出JSON，stderr打印一张可直接贴进文档的表
+#include <getopt.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+#include <opencv2/imgcodecs.hpp>
+#include "BenchUtils.h"
+#include "LayoutNet.h"
+#include "OcrUtils.h"
+
+struct TierStats {
+    std::vector<double> latencyMs;
+    long referenceBoxes = 0;
+    long detectedBoxes = 0;
+    long matchedBoxes = 0;
+    std::map<int, int> picks; // 自动模式选中的档位 -> 页数
+};
+
+static std::vector<std::string> listPages(const std::string &dir) {
+    static const char *exts[] = {".jpg", ".jpeg", ".png", ".bmp", ".tif", ".tiff", ".webp"};
+    std::vector<std::string> pages;
+    for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+        if (!entry.is_regular_file()) continue;
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        for (const char *e : exts) {
+            if (ext == e) {
+                pages.push_back(entry.path().string());
+                break;
+            }
+        }
+    }
+    std::sort(pages.begin(), pages.end());
+    return pages;
+}
+
+static float boxIoU(const LayoutBox &a, const LayoutBox &b) {
+    cv::Rect ra(a.boxPoint[0], a.boxPoint[2]);
+    cv::Rect rb(b.boxPoint[0], b.boxPoint[2]);
+    int inter = (ra & rb).area();
+    int uni = ra.area() + rb.area() - inter;
+    return uni > 0 ? (float) inter / uni : 0.0f;
+}
+
+// 按分数从高到低贪心匹配同类框，返回匹配数
+static int matchBoxes(const std::vector<LayoutBox> &reference, std::vector<LayoutBox> boxes) {
+    std::sort(boxes.begin(), boxes.end(),
+              [](const LayoutBox &a, const LayoutBox &b) { return a.score > b.score; });
+    std::vector<bool> used(reference.size(), false);
+    int matched = 0;
+    for (const auto &box : boxes) {
+        int best = -1;
+        float bestIoU = 0.5f;
+        for (size_t i = 0; i < reference.size(); ++i) {
+            if (used[i] || reference[i].type != box.type) continue;
+            float iou = boxIoU(reference[i], box);
+            if (iou >= bestIoU) {
+                bestIoU = iou;
+                best = (int) i;
+            }
+        }
+        if (best >= 0) {
+            used[best] = true;
+            matched++;
+        }
+    }
+    return matched;
+}
+
+static void printUsage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s --model PATH --pages DIR [options]\n"
+            "  -m, --model PATH             layout model exported with dynamic input\n"
+            "  -P, --pages DIR              directory of page images\n"
+            "  -n, --iterations N           timed runs per page and tier (default 3)\n"
+            "  -t, --numThread N            (default 4)\n"
+            "  -L, --layoutScoreThresh F    (default 0.1)\n"
+            "  -j, --json PATH              write the JSON report to PATH instead of stdout\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    std::string modelPath;
+    std::string pagesDir;
+    std::string jsonPath;
+    int iterations = 3;
+    int numThread = 4;
+    float layoutScoreThresh = 0.1f;
+
+    static const struct option longOptions[] = {
+            {"model",             required_argument, NULL, 'm'},
+            {"pages",             required_argument, NULL, 'P'},
+            {"iterations",        required_argument, NULL, 'n'},
+            {"numThread",         required_argument, NULL, 't'},
+            {"layoutScoreThresh", required_argument, NULL, 'L'},
+            {"json",              required_argument, NULL, 'j'},
+            {"help",              no_argument,       NULL, 'h'},
+            {NULL,                no_argument,       NULL, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "m:P:n:t:L:j:h", longOptions, NULL)) != -1) {
+        switch (opt) {
+            case 'm': modelPath = optarg; break;
+            case 'P': pagesDir = optarg; break;
+            case 'n': iterations = std::max(1, atoi(optarg)); break;
+            case 't': numThread = atoi(optarg); break;
+            case 'L': layoutScoreThresh = strtof(optarg, NULL); break;
+            case 'j': jsonPath = optarg; break;
+            default:
+                printUsage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (modelPath.empty() || pagesDir.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    LayoutNet layoutNet;
+    layoutNet.setNumThread(numThread);
+    layoutNet.initModel(modelPath);
+    if (layoutNet.getModelBytes() == 0) {
+        LOGE("cannot load %s", modelPath.c_str());
+        return 1;
+    }
+    if (!layoutNet.isDynamicInput()) {
+        LOGE("%s has a fixed input size, tiers do not apply", modelPath.c_str());
+        return 1;
+    }
+
+    // 档位列表，0表示自动选档；参照为最大档
+    std::vector<int> tiers(std::begin(LayoutNet::INPUT_TIERS), std::end(LayoutNet::INPUT_TIERS));
+    const int referenceTier = tiers.back();
+    tiers.push_back(0);
+    std::map<int, TierStats> stats;
+
+    int pageCount = 0;
+    for (const auto &path : listPages(pagesDir)) {
+        cv::Mat page = cv::imread(path, cv::IMREAD_COLOR);
+        if (page.empty()) {
+            LOGW("skip unreadable page: %s", path.c_str());
+            continue;
+        }
+        pageCount++;
+        std::vector<LayoutBox> reference =
+                layoutNet.getLayoutBoxes(page, layoutScoreThresh, referenceTier).layoutBoxes;
+        for (int tier : tiers) {
+            TierStats &tierStats = stats[tier];
+            layoutNet.setInputSize(tier);
+            // 第一次运行让该输入形状的kernel与arena就绪，不计时
+            LayoutResult result = layoutNet.getLayoutBoxes(page, layoutScoreThresh);
+            for (int i = 0; i < iterations; ++i) {
+                double start = benchNowMs();
+                result = layoutNet.getLayoutBoxes(page, layoutScoreThresh);
+                tierStats.latencyMs.push_back(benchNowMs() - start);
+            }
+            tierStats.referenceBoxes += reference.size();
+            tierStats.detectedBoxes += result.layoutBoxes.size();
+            tierStats.matchedBoxes += matchBoxes(reference, result.layoutBoxes);
+            if (tier == 0) tierStats.picks[result.inputSize.width]++;
+        }
+    }
+    if (pageCount == 0) {
+        LOGE("no pages found in %s", pagesDir.c_str());
+        return 1;
+    }
+
+    fprintf(stderr, "| tier | p50 ms | p90 ms | recall vs %d | precision vs %d |\n", referenceTier,
+            referenceTier);
+    fprintf(stderr, "|------|--------|--------|-------------|----------------|\n");
+    std::string json = "{\"pages\": " + std::to_string(pageCount) + ", \"reference\": " +
+                       std::to_string(referenceTier) + ", \"tiers\": [";
+    for (size_t i = 0; i < tiers.size(); ++i) {
+        int tier = tiers[i];
+        const TierStats &tierStats = stats[tier];
+        BenchStats latency = benchComputeStats(tierStats.latencyMs);
+        double recall = tierStats.referenceBoxes > 0 ?
+                        (double) tierStats.matchedBoxes / tierStats.referenceBoxes : 1.0;
+        double precision = tierStats.detectedBoxes > 0 ?
+                           (double) tierStats.matchedBoxes / tierStats.detectedBoxes : 1.0;
+        std::string name = tier > 0 ? std::to_string(tier) : "auto";
+        std::string picks;
+        for (const auto &pick : tierStats.picks) {
+            picks += std::string(picks.empty() ? "" : ", ") + "\"" + std::to_string(pick.first) +
+                     "\": " + std::to_string(pick.second);
+        }
+        fprintf(stderr, "| %s | %.1f | %.1f | %.3f | %.3f |\n", name.c_str(), latency.p50,
+                latency.p90, recall, precision);
+        char buf[512];
+        snprintf(buf, sizeof(buf),
+                 "%s{\"tier\": \"%s\", \"p50_ms\": %.3f, \"p90_ms\": %.3f, \"recall\": %.4f, "
+                 "\"precision\": %.4f, \"picks\": {%s}}",
+                 i > 0 ? ", " : "", name.c_str(), latency.p50, latency.p90, recall, precision,
+                 picks.c_str());
+        json += buf;
+    }
+    json += "]}\n";
+
+    if (jsonPath.empty()) {
+        fputs(json.c_str(), stdout);
+    } else {
+        FILE *fp = fopen(jsonPath.c_str(), "w");
+        if (fp == NULL) {
+            LOGE("cannot write %s", jsonPath.c_str());
+            return 1;
+        }
+        fputs(json.c_str(), fp);
+        fclose(fp);
+    }
+    return 0;
+}
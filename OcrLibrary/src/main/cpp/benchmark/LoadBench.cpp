@@ -0,0 +1,201 @@
+// 动态库加载基准：每次在新fork出的子进程里 dlopen(RTLD_NOW)，统计加载（含重定位）耗时、缺页和RSS增量，
+// 以及这次新载入的全部对象（含依赖，如libonnxruntime.so）的文件大小与重定位条目数。
+// 用来比较 共享ORT（libRapidOcr + libonnxruntime.so）与 静态链接裁剪版ORT 的冷启动开销
+#include <getopt.h>
+#include <dlfcn.h>
+#include <link.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "BenchUtils.h"
+
+struct LoadSample {
+    int ok;
+    double loadMs;
+    long minorFaults;
+    long majorFaults;
+    long rssKb;
+    int objects;
+    long long fileBytes;
+    long long relocations;
+};
+
+static int collectNames(struct dl_phdr_info *info, size_t, void *data) {
+    ((std::set<std::string> *) data)->insert(info->dlpi_name != nullptr ? info->dlpi_name : "");
+    return 0;
+}
+
+struct NewObjects {
+    const std::set<std::string> *before;
+    int objects;
+    long long fileBytes;
+    long long relocations;
+};
+
+// 按动态段里的 REL/RELA/JMPREL 大小统计重定位条目数（不含Android打包重定位与RELR）
+static long long countRelocations(struct dl_phdr_info *info) {
+    long long count = 0;
+    for (int i = 0; i < info->dlpi_phnum; ++i) {
+        if (info->dlpi_phdr[i].p_type != PT_DYNAMIC) continue;
+        const ElfW(Dyn) *dyn = (const ElfW(Dyn) *) (info->dlpi_addr + info->dlpi_phdr[i].p_vaddr);
+        long long relaSize = 0, relSize = 0, pltSize = 0;
+        long long pltType = DT_RELA;
+        for (; dyn->d_tag != DT_NULL; ++dyn) {
+            switch (dyn->d_tag) {
+                case DT_RELASZ: relaSize = dyn->d_un.d_val; break;
+                case DT_RELSZ: relSize = dyn->d_un.d_val; break;
+                case DT_PLTRELSZ: pltSize = dyn->d_un.d_val; break;
+                case DT_PLTREL: pltType = dyn->d_un.d_val; break;
+                default: break;
+            }
+        }
+        count += relaSize / sizeof(ElfW(Rela)) + relSize / sizeof(ElfW(Rel));
+        count += pltSize / (pltType == DT_RELA ? sizeof(ElfW(Rela)) : sizeof(ElfW(Rel)));
+    }
+    return count;
+}
+
+static int collectNewObjects(struct dl_phdr_info *info, size_t, void *data) {
+    NewObjects *result = (NewObjects *) data;
+    std::string name = info->dlpi_name != nullptr ? info->dlpi_name : "";
+    if (name.empty() || result->before->count(name)) return 0;
+    struct stat st;
+    result->objects++;
+    if (stat(name.c_str(), &st) == 0) result->fileBytes += st.st_size;
+    result->relocations += countRelocations(info);
+    return 0;
+}
+
+static long readRssKb() {
+    FILE *fp = fopen("/proc/self/statm", "r");
+    if (fp == nullptr) return 0;
+    long total = 0, resident = 0;
+    if (fscanf(fp, "%ld %ld", &total, &resident) != 2) resident = 0;
+    fclose(fp);
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// 子进程里加载一次，结果经管道交回父进程；每次都是全新的进程，不受已加载对象影响
+static LoadSample loadOnce(const std::string &path) {
+    LoadSample sample{};
+    int fds[2];
+    if (pipe(fds) != 0) return sample;
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        std::set<std::string> before;
+        dl_iterate_phdr(collectNames, &before);
+        struct rusage usageBefore, usageAfter;
+        getrusage(RUSAGE_SELF, &usageBefore);
+        long rssBefore = readRssKb();
+        double start = benchNowMs();
+        void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        double loadMs = benchNowMs() - start;
+        getrusage(RUSAGE_SELF, &usageAfter);
+        LoadSample result{};
+        if (handle != nullptr) {
+            NewObjects objects{&before, 0, 0, 0};
+            dl_iterate_phdr(collectNewObjects, &objects);
+            result = {1, loadMs, usageAfter.ru_minflt - usageBefore.ru_minflt,
+                      usageAfter.ru_majflt - usageBefore.ru_majflt, readRssKb() - rssBefore,
+                      objects.objects, objects.fileBytes, objects.relocations};
+        } else {
+            fprintf(stderr, "dlopen %s failed: %s\n", path.c_str(), dlerror());
+        }
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == sizeof(result) ? 0 : 1);
+    }
+    close(fds[1]);
+    if (pid > 0) {
+        if (read(fds[0], &sample, sizeof(sample)) != sizeof(sample)) sample.ok = 0;
+        waitpid(pid, nullptr, 0);
+    }
+    close(fds[0]);
+    return sample;
+}
+
+static void printUsage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s [options] LIB.so [LIB2.so ...]\n"
+            "  -n, --iterations N           fresh-process loads per library (default 20)\n"
+            "  -j, --json PATH              write the JSON report to PATH instead of stdout\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    int iterations = 20;
+    std::string jsonPath;
+    static const struct option longOptions[] = {
+            {"iterations", required_argument, NULL, 'n'},
+            {"json",       required_argument, NULL, 'j'},
+            {"help",       no_argument,       NULL, 'h'},
+            {NULL,         no_argument,       NULL, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "n:j:h", longOptions, NULL)) != -1) {
+        switch (opt) {
+            case 'n': iterations = atoi(optarg); break;
+            case 'j': jsonPath = optarg; break;
+            case 'h':
+            default:
+                printUsage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (optind >= argc || iterations <= 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string json = "{\"libraries\": [";
+    for (int arg = optind; arg < argc; ++arg) {
+        std::string path = argv[arg];
+        std::vector<double> loadMs;
+        LoadSample last{};
+        long long minorFaults = 0, rssKb = 0;
+        for (int i = 0; i < iterations; ++i) {
+            LoadSample sample = loadOnce(path);
+            if (!sample.ok) break;
+            loadMs.push_back(sample.loadMs);
+            minorFaults += sample.minorFaults;
+            rssKb += sample.rssKb;
+            last = sample;
+        }
+        if (loadMs.empty()) return 1;
+        BenchStats stats = benchComputeStats(loadMs);
+        int n = stats.count;
+        fprintf(stderr, "%s: dlopen p50 %.3fms p90 %.3fms, %d objects %.2fMB, %lld relocations, "
+                        "%lld minor faults, rss +%lldKB\n",
+                path.c_str(), stats.p50, stats.p90, last.objects, last.fileBytes / 1048576.0,
+                last.relocations, minorFaults / n, rssKb / n);
+        char buf[768];
+        snprintf(buf, sizeof(buf),
+                 "%s{\"path\": \"%s\", \"count\": %d, \"p50_ms\": %.3f, \"p90_ms\": %.3f, "
+                 "\"max_ms\": %.3f, \"objects\": %d, \"file_bytes\": %lld, \"relocations\": %lld, "
+                 "\"minor_faults\": %lld, \"rss_kb\": %lld}",
+                 arg > optind ? ", " : "", path.c_str(), n, stats.p50, stats.p90, stats.max,
+                 last.objects, last.fileBytes, last.relocations, minorFaults / n, rssKb / n);
+        json += buf;
+    }
+    json += "]}\n";
+
+    if (jsonPath.empty()) {
+        fputs(json.c_str(), stdout);
+    } else {
+        FILE *fp = fopen(jsonPath.c_str(), "w");
+        if (fp == nullptr) {
+            fprintf(stderr, "cannot write %s\n", jsonPath.c_str());
+            return 1;
+        }
+        fputs(json.c_str(), fp);
+        fclose(fp);
+    }
+    return 0;
+}
@@ -0,0 +1,181 @@
+// 模型加载基准：比较原始模型与zstd压缩模型（model.onnx.zst）的 读取/解压 和 创建session 耗时
+// cold每次先用posix_fadvise把文件逐出页缓存（不需要root），warm直接读页缓存
+#include <getopt.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "BenchUtils.h"
+#include "ModelSource.h"
+#include "OcrUtils.h"
+
+static volatile unsigned long benchSink = 0;
+
+static void evictPageCache(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+static size_t fileSize(const std::string &path) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    return ec ? 0 : (size_t) size;
+}
+
+// 打开并读完每一页：原始模型mmap只建映射，ORT解析时才缺页，读一遍才与解压的工作量可比
+static void openAndTouch(const std::string &path) {
+    ModelSource source;
+    if (!source.openFile(path)) {
+        fprintf(stderr, "open %s failed\n", path.c_str());
+        exit(1);
+    }
+    const unsigned char *p = (const unsigned char *) source.data();
+    unsigned long sum = 0;
+    for (size_t i = 0; i < source.size(); i += 4096) sum += p[i];
+    benchSink += sum;
+}
+
+static void openAndCreateSession(const std::string &path) {
+    ModelSource source;
+    if (!source.openFile(path)) {
+        fprintf(stderr, "open %s failed\n", path.c_str());
+        exit(1);
+    }
+    Ort::SessionOptions options;
+    options.DisablePerSessionThreads();
+    Ort::Session *session = createSession(getOrtEnv(), source, options, "ModelLoadBench",
+                                          GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+    delete session;
+}
+
+static std::string statsToJson(const char *name, const BenchStats &stats) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "\"%s\": {\"p50_ms\": %.3f, \"p90_ms\": %.3f, \"min_ms\": %.3f}",
+             name, stats.p50, stats.p90, stats.min);
+    return buf;
+}
+
+static void printUsage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s --models DIR [options]\n"
+            "  -d, --models DIR             directory with MODEL and MODEL.zst pairs (zstd -19 MODEL)\n"
+            "  -n, --iterations N           timed loads per variant (default 10)\n"
+            "  -s, --session                also time session creation from each variant\n"
+            "  -t, --numThread N            ORT thread budget for --session (default 4)\n"
+            "  -j, --json PATH              write the JSON report to PATH instead of stdout\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    std::string modelsDir = ".";
+    std::string jsonPath;
+    int iterations = 10;
+    int numThread = 4;
+    bool session = false;
+
+    static const struct option longOptions[] = {
+            {"models",     required_argument, NULL, 'd'},
+            {"iterations", required_argument, NULL, 'n'},
+            {"session",    no_argument,       NULL, 's'},
+            {"numThread",  required_argument, NULL, 't'},
+            {"json",       required_argument, NULL, 'j'},
+            {"help",       no_argument,       NULL, 'h'},
+            {NULL,         no_argument,       NULL, 0}
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "d:n:st:j:h", longOptions, NULL)) != -1) {
+        switch (opt) {
+            case 'd': modelsDir = optarg; break;
+            case 'n': iterations = atoi(optarg); break;
+            case 's': session = true; break;
+            case 't': numThread = atoi(optarg); break;
+            case 'j': jsonPath = optarg; break;
+            case 'h':
+            default:
+                printUsage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    setOrtThreadBudget(numThread);
+
+    std::vector<std::string> models;
+    for (const auto &entry : std::filesystem::directory_iterator(modelsDir)) {
+        std::string path = entry.path().string();
+        std::string ext = entry.path().extension().string();
+        if ((ext == ".onnx" || ext == ".ort") && std::filesystem::exists(path + ".zst")) {
+            models.push_back(path);
+        }
+    }
+    std::sort(models.begin(), models.end());
+    if (models.empty()) {
+        fprintf(stderr, "no MODEL + MODEL.zst pairs in %s\n", modelsDir.c_str());
+        return 1;
+    }
+
+    std::string json = "{\"models\": [";
+    for (size_t m = 0; m < models.size(); ++m) {
+        const std::string &raw = models[m];
+        const std::string zst = raw + ".zst";
+        size_t rawSize = fileSize(raw);
+        size_t zstSize = fileSize(zst);
+        std::string name = std::filesystem::path(raw).filename().string();
+        json += std::string(m > 0 ? ", " : "") + "{\"name\": \"" + name + "\", \"raw_bytes\": " +
+                std::to_string(rawSize) + ", \"zstd_bytes\": " + std::to_string(zstSize);
+        fprintf(stderr, "%s: %.2fMB -> %.2fMB (%.1f%%)\n", name.c_str(), rawSize / 1048576.0,
+                zstSize / 1048576.0, rawSize > 0 ? zstSize * 100.0 / rawSize : 0.0);
+
+        struct Variant {
+            const char *name;
+            const std::string &path;
+            bool cold;
+            bool session;
+        };
+        std::vector<Variant> variants = {{"raw_read_cold", raw, true, false},
+                                         {"zstd_read_cold", zst, true, false},
+                                         {"raw_read_warm", raw, false, false},
+                                         {"zstd_read_warm", zst, false, false}};
+        if (session) {
+            variants.push_back({"raw_session_warm", raw, false, true});
+            variants.push_back({"zstd_session_warm", zst, false, true});
+        }
+        for (const auto &variant : variants) {
+            std::vector<double> samples;
+            for (int i = 0; i < iterations + 1; ++i) {
+                if (variant.cold) evictPageCache(variant.path);
+                double start = benchNowMs();
+                if (variant.session) {
+                    openAndCreateSession(variant.path);
+                } else {
+                    openAndTouch(variant.path);
+                }
+                // 第一次只用来把warm变体读进页缓存
+                if (i > 0 || variant.cold) samples.push_back(benchNowMs() - start);
+            }
+            BenchStats stats = benchComputeStats(samples);
+            fprintf(stderr, "  %-18s p50 %9.3fms  p90 %9.3fms\n", variant.name, stats.p50, stats.p90);
+            json += ", " + statsToJson(variant.name, stats);
+        }
+        json += "}";
+    }
+    json += "]}\n";
+
+    if (jsonPath.empty()) {
+        fputs(json.c_str(), stdout);
+    } else {
+        FILE *fp = fopen(jsonPath.c_str(), "w");
+        if (fp == nullptr) {
+            fprintf(stderr, "cannot write %s\n", jsonPath.c_str());
+            return 1;
+        }
+        fputs(json.c_str(), fp);
+        fclose(fp);
+    }
+    return 0;
+}
@@ -2,10 +2,16 @@
 #define __OCR_ANGLENET_H__
 
 #include "OcrStruct.h"
+#include "TensorBinding.h"
+#include "ModelSource.h"
 #include "onnxruntime/core/session/onnxruntime_cxx_api.h"
 #include <opencv2/core.hpp>
+#ifdef __ANDROID__
 #include <android/asset_manager.h>
 #include <android/asset_manager_jni.h>
+#endif
+
+class StageTimer;
 
 class AngleNet {
 public:
@@ -15,25 +21,53 @@ public:
 
     void setNumThread(int numOfThread);
 
+    // 开启ORT算子级profiling，须在initModel之前调用；ORT在prefix后追加时间戳生成json
+    void setProfiling(const std::string &prefix);
+
+    // 结束profiling，返回profile文件路径
+    std::string endProfiling();
+
+    // 卸载session并解除模型映射，之后可再次initModel
+    void releaseModel();
+
+    // 模型文件字节数（权重主体），0表示未加载过
+    size_t getModelBytes() const { return modelBytes; }
+
+    // 最近一次initModel的分段耗时
+    const ModelLoadTiming &getLoadTiming() const { return loadTiming; }
+
+#ifdef __ANDROID__
     void initModel(AAssetManager *mgr, const std::string &name);
+#endif
+
+    void initModel(const std::string &path);
+
+    std::vector<Angle> getAngles(std::vector<cv::Mat> &partImgs, bool doAngle, bool mostAngle,
+                                 NetTiming &timing);
 
-    std::vector<Angle> getAngles(std::vector<cv::Mat> &partImgs, bool doAngle, bool mostAngle);
+    // 按多数票把所有文本框的方向统一为0或1（getAngles的mostAngle）
+    static void applyMostAngle(std::vector<Angle> &angles);
 
 private:
-    Ort::Session *session;
-    Ort::Env ortEnv = Ort::Env(ORT_LOGGING_LEVEL_ERROR, "AngleNet");
+    Ort::Session *session = nullptr;
     Ort::SessionOptions sessionOptions = Ort::SessionOptions();
     int numThread = 0;
+    bool profiling = false;
+    int runCount = 0;
 
-    std::vector<Ort::AllocatedStringPtr> inputNamesPtr;
-    std::vector<Ort::AllocatedStringPtr> outputNamesPtr;
+    TensorBinding binding;
+    // ORT格式模型时session直接引用这块映射，须与session同生命周期
+    ModelSource modelSource;
+    size_t modelBytes = 0;
+    ModelLoadTiming loadTiming;
+    SharedPrepackedWeights prepackedWeights;
 
     const float meanValues[3] = {127.5, 127.5, 127.5};
     const float normValues[3] = {1.0 / 127.5, 1.0 / 127.5, 1.0 / 127.5};
     const int dstWidth = 192;
     const int dstHeight = 48;
 
-    Angle getAngle(cv::Mat &src);
+    Angle getAngle(cv::Mat &src, StageTimer &timer, NetTiming &timing);
 };
 
 
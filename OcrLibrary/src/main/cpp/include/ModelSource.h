@@ -0,0 +1,97 @@
+#ifndef __OCR_MODEL_SOURCE_H__
+#define __OCR_MODEL_SOURCE_H__
+
+#include "onnxruntime/core/session/onnxruntime_cxx_api.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#ifdef __ANDROID__
+#include <android/asset_manager.h>
+#endif
+
+// 模型/字典文件的只读字节视图，不复制文件内容：
+// 主机上mmap文件；Android上mmap未压缩asset的文件描述符（需在gradle里noCompress），
+// 压缩过的asset退回AAsset_getBuffer，由AssetManager负责解压。
+// zstd压缩的模型（name.zst，编译时找到zstd才支持）流式解压进匿名映射，不落临时文件；
+// 打开name时若它不存在而name.zst存在，自动改用压缩版本
+class ModelSource {
+public:
+    ModelSource() = default;
+
+    ~ModelSource();
+
+    ModelSource(const ModelSource &) = delete;
+
+    ModelSource &operator=(const ModelSource &) = delete;
+
+    ModelSource &operator=(ModelSource &&other) noexcept;
+
+    bool openFile(const std::string &path);
+
+#ifdef __ANDROID__
+    bool openAsset(AAssetManager *mgr, const std::string &name);
+#endif
+
+    void release();
+
+    const void *data() const { return ptr; }
+
+    size_t size() const { return length; }
+
+    bool isMapped() const { return mapBase != nullptr; }
+
+    // 是否由zstd压缩数据解压而来
+    bool isDecompressed() const { return decompressed; }
+
+    // ORT格式（flatbuffer，文件标识"ORTM"），可以让session直接引用这块内存
+    bool isOrtFormat() const;
+
+    // 按行切分（与std::getline一致，只按'\n'分割）
+    std::vector<std::string> readLines() const;
+
+private:
+    void *mapBase = nullptr;
+    size_t mapLength = 0;
+    const void *ptr = nullptr;
+    size_t length = 0;
+    bool decompressed = false;
+#ifdef __ANDROID__
+    AAsset *asset = nullptr;
+#endif
+
+    bool isZstd() const;
+
+    // 把当前的zstd数据解压进匿名映射并替换之，失败时release
+    bool decompressZstd(const std::string &name);
+};
+
+// 模型加载的分段耗时，单位毫秒
+struct ModelLoadTiming {
+    double readMs = 0;      // 打开并映射模型文件；mmap只建映射，缺页计入sessionMs
+    double sessionMs = 0;   // 创建session，含解析、图优化与权重预打包
+    bool optimized = false; // 本次是否做了图优化，命中缓存或本身是ORT格式时跳过
+    double keysMs = 0;      // 加载识别字表，仅CrnnNet
+};
+
+// 优化后模型的缓存目录（进程内共享），空表示不缓存；须在initModel之前设置
+void setModelCacheDir(const std::string &dir);
+
+// 同一模型的多个session（如多个OcrLite实例）共享的预打包权重：ORT按 算子+权重内容 查找，已有则直接引用，
+// N个实例不再各存一份。按key（模型路径或asset名）分组，最后一个持有者释放时一起释放，
+// 空闲卸载仍能归还这部分内存；须比用它创建的session活得久
+typedef std::shared_ptr<OrtPrepackedWeightsContainer> SharedPrepackedWeights;
+
+SharedPrepackedWeights getSharedPrepackedWeights(const std::string &key);
+
+// 从source创建session，按optLevel做图优化。ORT格式开启session.use_ort_model_bytes_directly，
+// 此时source须比session活得久；ONNX格式ORT解析时自行保存权重，创建完即释放source。
+// 设置了缓存目录时：以 模型内容哈希+ORT版本+优化级别+影响图结构的session配置项 为键（只按CPU EP考虑），命中则改为映射缓存的ORT格式模型并跳过图优化，
+// 未命中则本次创建时把优化后的图存成 netName_键.ort。timing非空时写入sessionMs和optimized；
+// prepackedWeights非空时预打包权重放进这个共享容器；开启了共享分配器（setOrtSharedAllocator）时改用Env上的arena
+Ort::Session *createSession(Ort::Env &env, ModelSource &source,
+                            Ort::SessionOptions &sessionOptions, const char *netName,
+                            GraphOptimizationLevel optLevel, ModelLoadTiming *timing = nullptr,
+                            OrtPrepackedWeightsContainer *prepackedWeights = nullptr);
+
+#endif //__OCR_MODEL_SOURCE_H__
@@ -0,0 +1,25 @@
+#ifndef __OCR_NORMALIZE_KERNELS_H__
+#define __OCR_NORMALIZE_KERNELS_H__
+
+#include <cstddef>
+#include <vector>
+
+// uint8 HWC -> float CHW 的 (x - mean) * norm 内核，按CPU特性在运行时选择
+// 一次处理一行pixels个像素：dst指向第0个平面中该行的起点，第ch个平面在 dst + ch * planeSize
+// scale = norm，bias = -mean * norm，结果与标量参考实现逐位一致
+typedef void (*NormalizeRowFunc)(const unsigned char *src, int pixels, int channels,
+                                 const float *scale, const float *bias,
+                                 float *dst, size_t planeSize);
+
+struct NormalizeKernel {
+    const char *name;
+    NormalizeRowFunc func;
+};
+
+// 当前CPU支持的全部实现，第一个是标量参考实现，最后一个最快
+const std::vector<NormalizeKernel> &getNormalizeKernels();
+
+// 运行时选中的实现（第一次调用时检测CPU并打印）
+const NormalizeKernel &getNormalizeKernel();
+
+#endif //__OCR_NORMALIZE_KERNELS_H__
@@ -8,6 +8,75 @@
 #include "AngleNet.h"
 #include "CrnnNet.h"
 #include "LayoutNet.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// 四个网络的创建方式
+enum class InitMode {
+    Eager = 0,      // 并行创建全部session，init在全部完成后返回
+    Background = 1, // 后台并行创建，init立即返回；detect/detectLayout只等待自己用到的网络
+    Lazy = 2        // init只记录模型位置，第一次用到某个网络时在调用线程创建
+};
+
+enum class NetStatus {
+    Unloaded = 0,
+    Loading = 1,
+    Ready = 2,
+    Failed = 3
+};
+
+enum NetIndex {
+    NET_DB = 0,
+    NET_ANGLE = 1,
+    NET_CRNN = 2,
+    NET_LAYOUT = 3,
+    NET_COUNT = 4
+};
+
+// 单个网络的内存占用。ORT 1.16没有按session查询分配器统计的接口，
+// 以创建/首次推理前后的进程RSS差值近似，多个网络并行加载或并发推理时会互相计入
+struct NetMemoryInfo {
+    const char *name;
+    NetStatus status;
+    size_t modelBytes;  // 模型文件大小（权重主体）
+    long loadRssBytes;  // 最近一次创建session时的RSS增量：权重、优化后的图、预打包权重
+    long arenaRssBytes; // 加载后第一次推理时的RSS增量：CPU arena与中间张量
+    int loadCount;      // session创建次数，含空闲卸载后的重新加载
+    double idleMs;      // 距上次使用的时间，未加载时为0
+};
+
+// init后的预热：在各网络的加载任务里（Eager/Background模式的后台线程）用空白输入按下列尺寸各跑一次，
+// 把arena扩到工作大小、完成kernel选择并把权重页换入，首个真实请求不再承担这些开销。
+// AngleNet固定48×192；LayoutNet按setLayoutInputSize的设置，自动模式下每个档位各跑一次，
+// rect输入时用A4竖版比例的空白页；开启级联时快速模型也跑一次
+struct WarmupConfig {
+    bool enabled = false;
+    int dbSideLen = 1024 + 2 * 50;                   // DbNet输入长边，即 maxSideLen + 2*padding
+    std::vector<int> crnnWidths = {160, 320, 640, 960}; // CrnnNet缩放到48高之后的宽度
+};
+
+// 单个网络从init开始到可用的耗时
+struct NetInitTiming {
+    const char *name;
+    double loadMs;   // 整个加载任务，含以下各段
+    double readMs;   // 打开并映射模型文件
+    double sessionMs;// 创建session，含图优化
+    bool optimized;  // 是否做了图优化；命中优化缓存时跳过，两次启动的sessionMs之差即图优化耗时
+    double keysMs;   // 加载识别字表，仅CrnnNet
+    double warmupMs; // 预热，未开启时为0
+    double readyMs;  // 从init开始到Ready，即time-to-ready；尚未就绪为0
+};
+
+// 一行可读的摘要，如 "DbNet ready model=2.3MB load=+6.1MB arena=+18.4MB loads=1 idle=3.2s"
+std::string formatNetMemory(const NetMemoryInfo &info);
+
+std::string formatInitTiming(const NetInitTiming &timing);
 
 class OcrLite {
 public:
@@ -15,8 +84,61 @@ public:
 
     ~OcrLite();
 
+#ifdef __ANDROID__
     void init(JNIEnv *jniEnv, jobject assetManager, int numOfThread, std::string detName,
               std::string clsName, std::string recName, std::string keysName, std::string layoutName);
+#endif
+
+    void init(int numOfThread, std::string detPath, std::string clsPath, std::string recPath,
+              std::string keysPath, std::string layoutPath);
+
+    // 整个进程的线程预算：ORT全局线程池、OpenCV和OpenMP都用这个数，避免各自开满核互相抢占
+    // init会以numOfThread调用它；ORT线程池在第一个session创建后固定，之后只影响OpenCV/OpenMP。
+    // omp_set_num_threads只作用于调用线程，在别的线程里跑的OpenMP区域仍用各自线程的设置
+    void setNumThread(int numOfThread);
+
+    // 须在init之前调用，默认Eager
+    void setInitMode(InitMode mode);
+
+    // 须在init之前调用。Eager模式init在预热完成后返回；Background模式请求会等到对应网络预热完；
+    // Lazy模式和空闲卸载后的重新加载不预热（首个请求本身就是预热）
+    void setWarmup(const WarmupConfig &config);
+
+    std::vector<NetInitTiming> getInitTiming();
+
+    NetStatus getNetStatus(NetIndex net) const;
+
+    // detect需要的DbNet/AngleNet/CrnnNet是否都已就绪
+    bool isOcrReady() const;
+
+    // detectLayout需要的LayoutNet是否已就绪
+    bool isLayoutReady() const;
+
+    // 网络空闲超过seconds秒即卸载session并解除模型映射，下次用到时在调用线程透明地重新创建；
+    // <=0关闭（默认）。正在推理的网络不会被卸载
+    void setIdleTimeout(double seconds);
+
+    std::vector<NetMemoryInfo> getNetMemory();
+
+    // LayoutNet输入边长：640/800/1024等32的倍数，0为按页面自动选档；只对动态输入的版面模型生效
+    void setLayoutInputSize(int size);
+
+    // LayoutNet输入只把短边补到32的倍数而不是正方形，见LayoutNet::setRectInput
+    void setLayoutRectInput(bool enabled);
+
+    // 版面两级级联，须在init之前调用：fastModel（与版面模型同样是路径或asset名）先分析，
+    // 不满足config的放行条件才跑完整模型，LayoutResult::stage记录结果来自哪一级。fastModel为空关闭
+    void setLayoutCascade(const std::string &fastModel,
+                          const LayoutCascadeConfig &config = LayoutCascadeConfig());
+
+    // 优化后模型（ORT格式）的缓存目录，须在init之前调用；下次启动命中缓存即跳过图优化
+    void setCacheDir(const std::string &dir);
+
+    // 对四个网络开启ORT profiling，须在init之前调用；文件名为 prefix_det/cls/rec/layout_时间戳.json
+    void setProfilePrefix(const std::string &prefix);
+
+    // 结束profiling，返回已写出的profile文件
+    std::vector<std::string> endProfiling();
 
     //void initLogger(bool isDebug);
 
@@ -26,7 +148,41 @@ public:
                      float boxScoreThresh, float boxThresh,
                      float unClipRatio, bool doAngle, bool mostAngle);
 
-    LayoutResult detectLayout(cv::Mat &src, float boxScoreThresh = 0.5f);
+    // handle>=0时把这一页的DbNet概率图、各文本框的方向与识别结果缓存在handle下，供refilter使用；
+    // 同一handle再次detect会替换掉之前的缓存（版面部分保留）
+    OcrResult detect(cv::Mat &src, int padding, int maxSideLen,
+                     float boxScoreThresh, float boxThresh,
+                     float unClipRatio, bool doAngle, bool mostAngle, int handle = -1);
+
+    // handle>=0时把LayoutNet的原始输出缓存在handle下，供refilterLayout使用
+    LayoutResult detectLayout(cv::Mat &src, float boxScoreThresh = 0.5f, int handle = -1);
+
+    // 缓存页数上限，超出时丢弃最久未用的页；0关闭缓存并清空（默认），此时带handle的调用与不带一样
+    void setRefilterCache(int pages);
+
+    // 丢弃handle的缓存
+    void releasePage(int handle);
+
+    // 按新阈值重新取文本框，不再跑DbNet：只重做二值化、轮廓与框评分。
+    // 几何与上次相同的框沿用缓存的方向和文字，只有新出现或变化的框才跑AngleNet/CrnnNet。
+    // handle没有缓存的DbNet输出时返回空结果
+    OcrResult refilter(int handle, float boxScoreThresh, float boxThresh,
+                       float unClipRatio, bool doAngle, bool mostAngle);
+
+    // 按新的置信度阈值重新解析缓存的版面输出，不再跑LayoutNet：只重做解码、NMS与绘制。
+    // handle没有缓存的版面输出时返回空结果
+    LayoutResult refilterLayout(int handle, float boxScoreThresh);
+
+    // 多页合成一个batch推理，结果与pages一一对应；每次Run最多maxBatch页（<=0取默认的8页）。
+    // 需要版面模型的batch维是动态的，否则退回逐页推理
+    std::vector<LayoutResult> detectLayoutBatch(std::vector<cv::Mat> &pages,
+                                                float boxScoreThresh = 0.5f,
+                                                int maxBatch = LayoutNet::DEFAULT_MAX_BATCH);
+
+    // 对版面中的文本类区域逐个做OCR（跳过figure/table，与DocLayoutAnalyzer一致），结果写入ocrText
+    void recognizeLayoutRegions(cv::Mat &src, LayoutResult &layoutResult, int padding,
+                                float boxScoreThresh, float boxThresh,
+                                float unClipRatio, bool doAngle, bool mostAngle);
 
 private:
     bool isLOG = true;
@@ -34,6 +190,95 @@ private:
     AngleNet angleNet;
     CrnnNet crnnNet;
     LayoutNet layoutNet;
+
+    InitMode initMode = InitMode::Eager;
+    std::mutex netMutex;
+    std::function<void()> netLoaders[NET_COUNT];
+    std::shared_future<void> netFutures[NET_COUNT];
+    std::atomic<int> netStatus[NET_COUNT] = {};
+    // 以下均由netMutex保护
+    int netUsers[NET_COUNT] = {};
+    double netLastUsed[NET_COUNT] = {};
+    bool netUsedSinceLoad[NET_COUNT] = {};
+    long netLoadRss[NET_COUNT] = {};
+    long netArenaRss[NET_COUNT] = {};
+    int netLoadCount[NET_COUNT] = {};
+    double idleTimeoutMs = 0;
+    WarmupConfig warmupConfig;
+    double initStartTime = 0;
+    double netLoadMs[NET_COUNT] = {};
+    double netWarmupMs[NET_COUNT] = {};
+    double netReadyMs[NET_COUNT] = {};
+    bool stopEvict = false;
+    std::condition_variable evictCondition;
+    std::thread evictThread;
+
+    // 一页的可重复阈值化的中间结果；angles与textLines以文本框四个顶点（textLines再加方向）为键
+    struct PageCache {
+        cv::Mat paddingSrc;
+        cv::Rect originRect;
+        DbNetRaw dbRaw;
+        bool hasDbRaw = false;
+        LayoutNet::RawOutput layoutRaw;
+        bool hasLayoutRaw = false;
+        std::map<std::vector<int>, Angle> angles;
+        std::map<std::vector<int>, TextLine> textLines;
+        long lastUsed = 0;
+    };
+    // pageMutex只保护pages表；同一页的缓存内容不要在多个线程里同时detect/refilter
+    std::mutex pageMutex;
+    std::map<int, std::shared_ptr<PageCache>> pages;
+    int pageCapacity = 0;
+    long pageClock = 0;
+#ifdef __ANDROID__
+    // Background/Lazy模式下init返回后仍要读asset，持有AssetManager的全局引用
+    JavaVM *javaVM = nullptr;
+    jobject assetManagerRef = nullptr;
+#endif
+
+    // 使用期间持有，保证网络已加载且不会被空闲卸载；首次使用时统计arena内存
+    class NetLease {
+    public:
+        NetLease(OcrLite &lite, NetIndex net);
+
+        ~NetLease();
+
+    private:
+        OcrLite &lite;
+        NetIndex net;
+        bool measure = false;
+        size_t rssBefore = 0;
+    };
+
+    // 按initMode启动各网络的loader
+    void startNets();
+
+    // 以policy创建网络，warmUp时创建后接着预热，调用方须持有netMutex
+    void launchNet(NetIndex net, std::launch policy, bool warmUp);
+
+    // 按warmupConfig用空白输入跑一遍网络
+    void warmUpNet(NetIndex net);
+
+    // 卸载网络，调用方须持有netMutex
+    void unloadNet(NetIndex net);
+
+    // 等待已启动的网络就绪，创建失败时抛出原异常
+    void waitNet(NetIndex net);
+
+    void evictIdleNets();
+
+    // 取handle的缓存，create时不存在则新建并按容量淘汰；缓存关闭或handle<0时返回空
+    std::shared_ptr<PageCache> getPage(int handle, bool create);
+
+    // detect的主体：cache非空时refilter为真则用缓存的概率图重新取框，否则跑DbNet并把概率图存入cache
+    OcrResult runDetect(cv::Mat &src, cv::Rect &originRect, ScaleParam &scale,
+                        float boxScoreThresh, float boxThresh, float unClipRatio,
+                        bool doAngle, bool mostAngle, PageCache *cache, bool refilter);
+
+    // 裁剪、方向分类与识别；cache非空时命中的框跳过对应网络，新结果写回cache
+    void recognizeTextBoxes(cv::Mat &src, std::vector<TextBox> &textBoxes, bool doAngle,
+                            bool mostAngle, PageCache *cache, PipelineTiming &timing,
+                            std::vector<Angle> &angles, std::vector<TextLine> &textLines);
 };
 
 
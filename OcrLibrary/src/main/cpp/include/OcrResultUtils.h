@@ -32,5 +32,8 @@ private:
 
 };
 
+// OcrResult/LayoutResult共用的耗时记录转换
+jobject newJPipelineTiming(JNIEnv *env, PipelineTiming &timing);
+
 
 #endif //__OCR_RESULT_UTILS_H__
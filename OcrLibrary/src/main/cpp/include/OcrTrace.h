@@ -0,0 +1,41 @@
+#ifndef __OCR_TRACE_H__
+#define __OCR_TRACE_H__
+
+#include <atomic>
+#include <string>
+
+// 流水线span记录，导出Chrome trace-event JSON，可在 chrome://tracing 或 ui.perfetto.dev 打开
+// 未开启时每个span只有一次原子读；开启后每个线程写自己的缓冲区
+class OcrTrace {
+public:
+    // 清空已有记录并开始记录
+    static void start();
+
+    static void stop();
+
+    static bool isEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    // startMs/endMs 与 getCurrentTime() 同一时钟
+    static void addSpan(const char *name, double startMs, double endMs);
+
+    static bool writeJson(const std::string &path);
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+// RAII span：构造到析构之间记为一个名为name的区间，name须为字符串常量
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *name);
+
+    ~TraceSpan();
+
+private:
+    const char *name;
+    double startMs;
+};
+
+#endif //__OCR_TRACE_H__
@@ -4,16 +4,37 @@
 #include <opencv2/core.hpp>
 #include "OcrStruct.h"
 #include "onnxruntime/core/session/onnxruntime_cxx_api.h"
+
+#ifndef TAG
+#define TAG "OcrLite"
+#endif
+
+#ifdef __ANDROID__
 #include <android/log.h>
 #include <android/asset_manager.h>
 #include <android/asset_manager_jni.h>
 
-#define TAG "OcrLite"
 #define LOGV(...) __android_log_print(ANDROID_LOG_VERBOSE,TAG,__VA_ARGS__)
 #define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG,TAG,__VA_ARGS__)
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO,TAG,__VA_ARGS__)
 #define LOGW(...) __android_log_print(ANDROID_LOG_WARN,TAG,__VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR,TAG,__VA_ARGS__)
+#else
+#include <cstdio>
+
+// 主机构建没有logcat，日志写到stderr；V/D/I级别默认关闭，避免刷屏
+#define __ENABLE_HOST_VERBOSE__ false
+#define HOST_LOG(level, ...) do { \
+  fprintf(stderr, "%s/%s: ", level, TAG); \
+  fprintf(stderr, __VA_ARGS__); \
+  fputc('\n', stderr); \
+} while (0)
+#define LOGV(...) do { if (__ENABLE_HOST_VERBOSE__) HOST_LOG("V", __VA_ARGS__); } while (0)
+#define LOGD(...) do { if (__ENABLE_HOST_VERBOSE__) HOST_LOG("D", __VA_ARGS__); } while (0)
+#define LOGI(...) do { if (__ENABLE_HOST_VERBOSE__) HOST_LOG("I", __VA_ARGS__); } while (0)
+#define LOGW(...) HOST_LOG("W", __VA_ARGS__)
+#define LOGE(...) HOST_LOG("E", __VA_ARGS__)
+#endif
 
 #define __ENABLE_CONSOLE__ false
 #define Logger(format, ...) {\
@@ -53,6 +74,27 @@ inline T clamp(T x, T min, T max) {
 
 double getCurrentTime();
 
+// 当前线程已消耗的CPU时间，单位毫秒
+double getThreadCpuTime();
+
+// 进程常驻内存（RSS）字节数，读/proc/self/statm，失败返回0
+size_t getResidentBytes();
+
+// 分阶段计时：lap()把上一段耗时累加到指定阶段并开始下一段
+// traceName非空且OcrTrace已开启时，这一段同时记为trace span
+class StageTimer {
+public:
+    StageTimer();
+
+    void restart();
+
+    void lap(StageTiming &timing, const char *traceName = nullptr);
+
+private:
+    double startWall;
+    double startCpu;
+};
+
 ScaleParam getScaleParam(cv::Mat &src, const float scale);
 
 ScaleParam getScaleParam(cv::Mat &src, const int targetSize);
@@ -77,23 +119,57 @@ cv::Mat getRotateCropImage(const cv::Mat &src, std::vector<cv::Point> box);
 
 cv::Mat adjustTargetImg(cv::Mat &src, int dstWidth, int dstHeight);
 
+cv::Mat makePadding(cv::Mat &src, const int padding);
+
 std::vector<cv::Point2f> getMinBoxes(const cv::RotatedRect &boxRect, float &maxSideLen);
 
 float boxScoreFast(const std::vector<cv::Point2f> &boxes, const cv::Mat &pred);
 
 cv::RotatedRect unClip(std::vector<cv::Point2f> box, float unClipRatio);
 
+struct NormalizeKernel;
+
 std::vector<float>
 substractMeanNormalize(cv::Mat &src, const float *meanVals, const float *normVals);
 
+// 写入调用方提供的CHW缓冲区（至少 rows*cols*channels 个float），src为uint8、最多4通道
+// kernel为空时使用运行时按CPU特性选中的SIMD实现，见NormalizeKernels.h
+void substractMeanNormalize(const cv::Mat &src, const float *meanVals, const float *normVals,
+                            float *dst, const NormalizeKernel *kernel = nullptr);
+
 std::vector<int> getAngleIndexes(std::vector<Angle> &angles);
 
 std::vector<Ort::AllocatedStringPtr> getInputNames(Ort::Session *session);
 
 std::vector<Ort::AllocatedStringPtr> getOutputNames(Ort::Session *session);
 
-void *getModelDataFromAssets(AAssetManager *mgr, const char *modelName, int &size);
+// 进程内所有session共享的线程预算，决定全局ORT线程池大小；<=0时取CPU核数
+// 全局线程池在第一次getOrtEnv()时创建，之后再修改只记录警告
+void setOrtThreadBudget(int numThread);
+
+int getOrtThreadBudget();
+
+// numThread<=0时取CPU核数，否则原样返回
+int resolveThreadBudget(int numThread);
+
+// 所有session改用注册在Env上的同一个CPU arena，而不是每个session一个：同进程多个实例轮流推理时
+// 中间张量的内存互相复用，RSS不再随实例数成倍增长。代价是arena只增不减，空闲卸载不再归还这部分内存。
+// 默认关闭；与线程预算一样须在第一次getOrtEnv()之前设置
+void setOrtSharedAllocator(bool enabled);
+
+bool isOrtSharedAllocator();
+
+// 进程内共享的Ort::Env，带全局intra/inter线程池；session须DisablePerSessionThreads
+Ort::Env &getOrtEnv();
+
+// 开启profiling时给每次Run打上"网络名#序号"标签，日志与profile里据此区分每次调用
+Ort::RunOptions getRunOptions(const char *netName, bool profiling, int &runCount);
+
+// 结束profiling并返回ORT写出的json路径，未开启时返回空串
+std::string endSessionProfiling(Ort::Session *session, bool &profiling);
 
+#ifdef __ANDROID__
 std::string jstringTostring(JNIEnv *env, jstring input);
+#endif
 
 #endif //__OCR_UTILS_H__
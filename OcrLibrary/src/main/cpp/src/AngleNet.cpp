@@ -1,50 +1,76 @@
 #include "AngleNet.h"
 #include "OcrUtils.h"
+#include "ModelSource.h"
+#include "OcrTrace.h"
 #include <numeric>
 
 AngleNet::AngleNet() {}
 
 AngleNet::~AngleNet() {
+    binding.reset();
     delete session;
-    inputNamesPtr.clear();
-    outputNamesPtr.clear();
 }
 
 void AngleNet::setNumThread(int numOfThread) {
     numThread = numOfThread;
     //===session options===
-    // Sets the number of threads used to parallelize the execution within nodes
-    // A value of 0 means ORT will pick a default
-    sessionOptions.SetIntraOpNumThreads(numThread);
-    //set OMP_NUM_THREADS=16
-
-    // Sets the number of threads used to parallelize the execution of the graph (across nodes)
-    // If sequential execution is enabled this value is ignored
-    // A value of 0 means ORT will pick a default
-    sessionOptions.SetInterOpNumThreads(numThread);
-
-    // Sets graph optimization level
-    // ORT_DISABLE_ALL -> To disable all optimizations
-    // ORT_ENABLE_BASIC -> To enable basic optimizations (Such as redundant node removals)
-    // ORT_ENABLE_EXTENDED -> To enable extended optimizations (Includes level 1 + more complex optimizations like node fusions)
-    // ORT_ENABLE_ALL -> To Enable All possible opitmizations
-    sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+    // 不再为每个session单独建intra/inter线程池，统一使用getOrtEnv()的全局线程池，
+    // 池大小即OcrLite的线程预算
+    setOrtThreadBudget(numThread);
+    sessionOptions.DisablePerSessionThreads();
 }
 
+void AngleNet::setProfiling(const std::string &prefix) {
+    profiling = !prefix.empty();
+    if (profiling) {
+        sessionOptions.EnableProfiling(prefix.c_str());
+    } else {
+        sessionOptions.DisableProfiling();
+    }
+}
+
+std::string AngleNet::endProfiling() {
+    return endSessionProfiling(session, profiling);
+}
+
+void AngleNet::releaseModel() {
+    binding.reset();
+    delete session;
+    session = nullptr;
+    prepackedWeights.reset();
+    modelSource.release();
+}
+
+#ifdef __ANDROID__
 void AngleNet::initModel(AAssetManager *mgr, const std::string &name) {
-    int dbModelDataLength = 0;
-    void *dbModelData = getModelDataFromAssets(mgr, name.c_str(), dbModelDataLength);
-    session = new Ort::Session(ortEnv, dbModelData, dbModelDataLength,
-                               sessionOptions);
-    free(dbModelData);
-    inputNamesPtr = getInputNames(session);
-    outputNamesPtr = getOutputNames(session);
+    double readStartTime = getCurrentTime();
+    modelSource.openAsset(mgr, name);
+    modelBytes = modelSource.size();
+    loadTiming.readMs = getCurrentTime() - readStartTime;
+    prepackedWeights = getSharedPrepackedWeights(name);
+    session = createSession(getOrtEnv(), modelSource, sessionOptions, "AngleNet",
+                            GraphOptimizationLevel::ORT_ENABLE_EXTENDED, &loadTiming,
+                            prepackedWeights.get());
+    binding.init(session);
+}
+#endif
+
+void AngleNet::initModel(const std::string &path) {
+    double readStartTime = getCurrentTime();
+    modelSource.openFile(path);
+    modelBytes = modelSource.size();
+    loadTiming.readMs = getCurrentTime() - readStartTime;
+    prepackedWeights = getSharedPrepackedWeights(path);
+    session = createSession(getOrtEnv(), modelSource, sessionOptions, "AngleNet",
+                            GraphOptimizationLevel::ORT_ENABLE_EXTENDED, &loadTiming,
+                            prepackedWeights.get());
+    binding.init(session);
 }
 
-Angle scoreToAngle(const std::vector<float> &outputData) {
+Angle scoreToAngle(const float *outputData, int64_t outputCount) {
     int maxIndex = 0;
     float maxScore = 0;
-    for (int i = 0; i < outputData.size(); i++) {
+    for (int i = 0; i < outputCount; i++) {
         if (outputData[i] > maxScore) {
             maxScore = outputData[i];
             maxIndex = i;
@@ -53,45 +79,36 @@ Angle scoreToAngle(const std::vector<float> &outputData) {
     return {maxIndex, maxScore};
 }
 
-Angle AngleNet::getAngle(cv::Mat &src) {
-
-    std::vector<float> inputTensorValues = substractMeanNormalize(src, meanValues, normValues);
-
-    std::array<int64_t, 4> inputShape{1, src.channels(), src.rows, src.cols};
+Angle AngleNet::getAngle(cv::Mat &src, StageTimer &timer, NetTiming &timing) {
+    float *inputData = binding.inputBuffer({1, src.channels(), src.rows, src.cols});
+    substractMeanNormalize(src, meanValues, normValues, inputData);
+    timer.lap(timing.preprocess, "AngleNet::preprocess");
 
-    auto memoryInfo = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
+    std::vector<int64_t> outputShape;
+    const float *outputData = binding.run(getRunOptions("AngleNet", profiling, runCount),
+                                          outputShape);
+    timer.lap(timing.inference, "AngleNet::inference");
 
-    Ort::Value inputTensor = Ort::Value::CreateTensor<float>(memoryInfo, inputTensorValues.data(),
-                                                             inputTensorValues.size(),
-                                                             inputShape.data(),
-                                                             inputShape.size());
-    assert(inputTensor.IsTensor());
-    std::vector<const char *> inputNames = {inputNamesPtr.data()->get()};
-    std::vector<const char *> outputNames = {outputNamesPtr.data()->get()};
-    auto outputTensor = session->Run(Ort::RunOptions{nullptr}, inputNames.data(), &inputTensor,
-                                     inputNames.size(), outputNames.data(), outputNames.size());
-
-    assert(outputTensor.size() == 1 && outputTensor.front().IsTensor());
-
-    std::vector<int64_t> outputShape = outputTensor[0].GetTensorTypeAndShapeInfo().GetShape();
-
-    int64_t outputCount = std::accumulate(outputShape.begin(), outputShape.end(), 1,
+    int64_t outputCount = std::accumulate(outputShape.begin(), outputShape.end(), (int64_t) 1,
                                           std::multiplies<int64_t>());
-
-    float *floatArray = outputTensor.front().GetTensorMutableData<float>();
-    std::vector<float> outputData(floatArray, floatArray + outputCount);
-    return scoreToAngle(outputData);
+    Angle angle = scoreToAngle(outputData, outputCount);
+    timer.lap(timing.postprocess, "AngleNet::postprocess");
+    return angle;
 }
 
 std::vector<Angle> AngleNet::getAngles(std::vector<cv::Mat> &partImgs,
-                                       bool doAngle, bool mostAngle) {
+                                       bool doAngle, bool mostAngle, NetTiming &timing) {
+    TraceSpan span("AngleNet::getAngles");
+    StageTimer timer;
     int size = partImgs.size();
     std::vector<Angle> angles(size);
     if (doAngle) {
         for (int i = 0; i < size; ++i) {
+            TraceSpan angleSpan("AngleNet::getAngle");
             double startAngle = getCurrentTime();
+            timer.restart();
             auto angleImg = adjustTargetImg(partImgs[i], dstWidth, dstHeight);
-            Angle angle = getAngle(angleImg);
+            Angle angle = getAngle(angleImg, timer, timing);
             double endAngle = getCurrentTime();
             angle.time = endAngle - startAngle;
 
@@ -104,23 +121,27 @@ std::vector<Angle> AngleNet::getAngles(std::vector<cv::Mat> &partImgs,
         }
     }
     //Most Possible AngleIndex
-    if (doAngle && mostAngle) {
-        auto angleIndexes = getAngleIndexes(angles);
-        double sum = std::accumulate(angleIndexes.begin(), angleIndexes.end(), 0.0);
-        double halfPercent = angles.size() / 2.0f;
-        int mostAngleIndex;
-        if (sum < halfPercent) {//all angle set to 0
-            mostAngleIndex = 0;
-        } else {//all angle set to 1
-            mostAngleIndex = 1;
-        }
-        Logger("Set All Angle to mostAngleIndex(%d)", mostAngleIndex);
-        for (int i = 0; i < angles.size(); ++i) {
-            Angle angle = angles[i];
-            angle.index = mostAngleIndex;
-            angles.at(i) = angle;
-        }
-    }
+    timer.restart();
+    if (doAngle && mostAngle) applyMostAngle(angles);
+    timer.lap(timing.postprocess, "AngleNet::mostAngle");
 
     return angles;
+}
+
+void AngleNet::applyMostAngle(std::vector<Angle> &angles) {
+    auto angleIndexes = getAngleIndexes(angles);
+    double sum = std::accumulate(angleIndexes.begin(), angleIndexes.end(), 0.0);
+    double halfPercent = angles.size() / 2.0f;
+    int mostAngleIndex;
+    if (sum < halfPercent) {//all angle set to 0
+        mostAngleIndex = 0;
+    } else {//all angle set to 1
+        mostAngleIndex = 1;
+    }
+    Logger("Set All Angle to mostAngleIndex(%d)", mostAngleIndex);
+    for (int i = 0; i < angles.size(); ++i) {
+        Angle angle = angles[i];
+        angle.index = mostAngleIndex;
+        angles.at(i) = angle;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,448 @@
+#include "ModelSource.h"
+#include "OcrUtils.h"
+#include <cerrno>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef OCR_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+ModelSource::~ModelSource() {
+    release();
+}
+
+ModelSource &ModelSource::operator=(ModelSource &&other) noexcept {
+    if (this != &other) {
+        release();
+        std::swap(mapBase, other.mapBase);
+        std::swap(mapLength, other.mapLength);
+        std::swap(ptr, other.ptr);
+        std::swap(length, other.length);
+        std::swap(decompressed, other.decompressed);
+#ifdef __ANDROID__
+        std::swap(asset, other.asset);
+#endif
+    }
+    return *this;
+}
+
+// offset不必页对齐：向下对齐后映射，ptr指回真正的起点
+static void *mapRange(int fd, off_t offset, size_t length, void *&mapBase, size_t &mapLength) {
+    long pageSize = sysconf(_SC_PAGESIZE);
+    off_t alignedOffset = offset - offset % pageSize;
+    size_t delta = (size_t) (offset - alignedOffset);
+    void *base = mmap(nullptr, length + delta, PROT_READ, MAP_PRIVATE, fd, alignedOffset);
+    if (base == MAP_FAILED) {
+        return nullptr;
+    }
+    // ORT解析ONNX是顺序读
+    madvise(base, length + delta, MADV_SEQUENTIAL);
+    mapBase = base;
+    mapLength = length + delta;
+    return (char *) base + delta;
+}
+
+bool ModelSource::openFile(const std::string &path) {
+    release();
+    std::string zstdPath = path + ".zst";
+    if (access(path.c_str(), F_OK) != 0 && access(zstdPath.c_str(), F_OK) == 0) {
+        return openFile(zstdPath);
+    }
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOGE("open %s failed: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        LOGE("stat %s failed", path.c_str());
+        close(fd);
+        return false;
+    }
+    ptr = mapRange(fd, 0, (size_t) st.st_size, mapBase, mapLength);
+    close(fd);
+    if (ptr == nullptr) {
+        LOGE("mmap %s failed: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+    length = (size_t) st.st_size;
+    return isZstd() ? decompressZstd(path) : true;
+}
+
+#ifdef __ANDROID__
+bool ModelSource::openAsset(AAssetManager *mgr, const std::string &name) {
+    release();
+    if (mgr == NULL) {
+        LOGE(" %s", "AAssetManager==NULL");
+        return false;
+    }
+    AAsset *opened = AAssetManager_open(mgr, name.c_str(), AASSET_MODE_STREAMING);
+    if (opened == NULL) {
+        std::string zstdName = name + ".zst";
+        AAsset *compressed = AAssetManager_open(mgr, zstdName.c_str(), AASSET_MODE_STREAMING);
+        if (compressed != NULL) {
+            AAsset_close(compressed);
+            return openAsset(mgr, zstdName);
+        }
+        LOGE("asset %s not found", name.c_str());
+        return false;
+    }
+    // 未压缩的asset可以拿到apk的fd和偏移，直接映射
+    off64_t start = 0;
+    off64_t assetLength = 0;
+    int fd = AAsset_openFileDescriptor64(opened, &start, &assetLength);
+    if (fd >= 0) {
+        ptr = mapRange(fd, start, (size_t) assetLength, mapBase, mapLength);
+        close(fd);
+        if (ptr != nullptr) {
+            length = (size_t) assetLength;
+            AAsset_close(opened);
+            LOGI("asset %s mmapped, %zu bytes", name.c_str(), length);
+            return isZstd() ? decompressZstd(name) : true;
+        }
+    }
+    AAsset_close(opened);
+
+    // 压缩的asset：AASSET_MODE_BUFFER由AssetManager解压到自己的缓冲区，asset保持打开直到release
+    LOGW("asset %s is compressed, add it to androidResources.noCompress to mmap it",
+         name.c_str());
+    asset = AAssetManager_open(mgr, name.c_str(), AASSET_MODE_BUFFER);
+    if (asset == NULL) {
+        return false;
+    }
+    ptr = AAsset_getBuffer(asset);
+    length = (size_t) AAsset_getLength(asset);
+    if (ptr == nullptr) {
+        release();
+        return false;
+    }
+    return isZstd() ? decompressZstd(name) : true;
+}
+#endif
+
+bool ModelSource::isZstd() const {
+    static const unsigned char zstdMagic[4] = {0x28, 0xB5, 0x2F, 0xFD};
+    return length >= 4 && memcmp(ptr, zstdMagic, 4) == 0;
+}
+
+#ifdef OCR_WITH_ZSTD
+bool ModelSource::decompressZstd(const std::string &name) {
+    double startTime = getCurrentTime();
+    unsigned long long contentSize = ZSTD_getFrameContentSize(ptr, length);
+    if (contentSize == ZSTD_CONTENTSIZE_ERROR || contentSize == ZSTD_CONTENTSIZE_UNKNOWN ||
+        contentSize == 0) {
+        LOGE("%s: zstd frame without content size, compress it with the zstd command line tool",
+             name.c_str());
+        release();
+        return false;
+    }
+    void *out = mmap(nullptr, contentSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (out == MAP_FAILED) {
+        LOGE("%s: mmap %llu bytes failed: %s", name.c_str(), contentSize, strerror(errno));
+        release();
+        return false;
+    }
+    // 按块喂入，已解压完的压缩数据页随即交还（文件映射才可以，AAsset缓冲区不动）
+    const size_t chunkSize = 1 << 20;
+    long pageSize = sysconf(_SC_PAGESIZE);
+    ZSTD_DStream *stream = ZSTD_createDStream();
+    ZSTD_initDStream(stream);
+    ZSTD_outBuffer outBuffer = {out, (size_t) contentSize, 0};
+    const char *src = (const char *) ptr;
+    size_t consumed = 0;
+    size_t released = 0;
+    bool ok = true;
+    while (consumed < length && ok) {
+        ZSTD_inBuffer inBuffer = {src + consumed, (std::min)(chunkSize, length - consumed), 0};
+        while (inBuffer.pos < inBuffer.size) {
+            size_t ret = ZSTD_decompressStream(stream, &outBuffer, &inBuffer);
+            if (ZSTD_isError(ret)) {
+                LOGE("%s: zstd decompress failed: %s", name.c_str(), ZSTD_getErrorName(ret));
+                ok = false;
+                break;
+            }
+            if (outBuffer.pos == outBuffer.size && inBuffer.pos < inBuffer.size && ret != 0) {
+                LOGE("%s: zstd content larger than its header says", name.c_str());
+                ok = false;
+                break;
+            }
+        }
+        consumed += inBuffer.pos;
+        if (mapBase != nullptr) {
+            size_t mapOffset = (size_t) (src + consumed - (const char *) mapBase);
+            size_t end = mapOffset - mapOffset % pageSize;
+            if (end > released) {
+                madvise((char *) mapBase + released, end - released, MADV_DONTNEED);
+                released = end;
+            }
+        }
+    }
+    ZSTD_freeDStream(stream);
+    if (!ok || outBuffer.pos != contentSize) {
+        if (ok) LOGE("%s: zstd content truncated", name.c_str());
+        munmap(out, contentSize);
+        release();
+        return false;
+    }
+    mprotect(out, contentSize, PROT_READ);
+    size_t compressedSize = length;
+    release();
+    mapBase = out;
+    mapLength = contentSize;
+    ptr = out;
+    length = contentSize;
+    decompressed = true;
+    LOGI("%s: zstd %zu -> %zu bytes (%fms)", name.c_str(), compressedSize, length,
+         getCurrentTime() - startTime);
+    return true;
+}
+#else
+bool ModelSource::decompressZstd(const std::string &name) {
+    LOGE("%s is zstd compressed, but RapidOcr was built without zstd", name.c_str());
+    release();
+    return false;
+}
+#endif
+
+void ModelSource::release() {
+    if (mapBase != nullptr) {
+        munmap(mapBase, mapLength);
+        mapBase = nullptr;
+        mapLength = 0;
+    }
+#ifdef __ANDROID__
+    if (asset != nullptr) {
+        AAsset_close(asset);
+        asset = nullptr;
+    }
+#endif
+    ptr = nullptr;
+    length = 0;
+    decompressed = false;
+}
+
+bool ModelSource::isOrtFormat() const {
+    return length >= 8 && memcmp((const char *) ptr + 4, "ORTM", 4) == 0;
+}
+
+std::vector<std::string> ModelSource::readLines() const {
+    std::vector<std::string> lines;
+    const char *begin = (const char *) ptr;
+    const char *end = begin + length;
+    while (begin < end) {
+        const char *newline = (const char *) memchr(begin, '\n', end - begin);
+        const char *lineEnd = newline != nullptr ? newline : end;
+        lines.emplace_back(begin, lineEnd);
+        begin = newline != nullptr ? newline + 1 : end;
+    }
+    return lines;
+}
+
+static std::mutex cacheDirMutex;
+static std::string modelCacheDir;
+
+void setModelCacheDir(const std::string &dir) {
+    std::lock_guard<std::mutex> lock(cacheDirMutex);
+    modelCacheDir = dir;
+    if (!dir.empty() && mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) {
+        LOGE("create model cache dir %s failed: %s", dir.c_str(), strerror(errno));
+    }
+}
+
+static std::string getModelCacheDir() {
+    std::lock_guard<std::mutex> lock(cacheDirMutex);
+    return modelCacheDir;
+}
+
+// 64位FNV-1a风格的逐8字节哈希，整个模型只读一遍
+static uint64_t hashBytes(const void *data, size_t size) {
+    const unsigned char *p = (const unsigned char *) data;
+    uint64_t hash = 14695981039346656037ULL ^ size;
+    size_t words = size / 8;
+    for (size_t i = 0; i < words; ++i) {
+        uint64_t word;
+        memcpy(&word, p + i * 8, 8);
+        hash = (hash ^ word) * 1099511628211ULL;
+        hash ^= hash >> 29;
+    }
+    for (size_t i = words * 8; i < size; ++i) {
+        hash = (hash ^ p[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// 会改变优化后图结构的session配置项（见ORT的onnxruntime_session_options_config_keys.h），设置了就计入缓存键
+static const char *GRAPH_CONFIG_KEYS[] = {
+        "optimization.disable_specified_optimizers",
+        "optimization.enable_gelu_approximation",
+        "optimization.minimal_build_optimizations",
+        "session.disable_quant_qdq",
+        "session.enable_quant_qdq_cleanup",
+        "session.disable_double_qdq_remover",
+        "session.qdqisint8allowed",
+        "session.x64quantprecision",
+        "session.disable_aot_function_inlining",
+};
+
+// 键 = 模型内容 + ORT版本 + 优化级别 + 上述配置项。执行提供器和free dimension覆盖无法从
+// OrtSessionOptions读回：四个网络都只用CPU EP、不覆盖维度，键里固定记为cpu；
+// 以后给某个网络加EP或维度覆盖时，须换用不同的netName，否则会命中CPU图的缓存
+static std::string getCacheKey(const ModelSource &source, const Ort::SessionOptions &sessionOptions,
+                               GraphOptimizationLevel optLevel) {
+    std::string identity = Ort::GetVersionString() + "|opt=" + std::to_string((int) optLevel) +
+                           "|ep=cpu";
+    for (const char *configKey : GRAPH_CONFIG_KEYS) {
+        if (sessionOptions.HasConfigEntry(configKey)) {
+            identity += std::string("|") + configKey + "=" + sessionOptions.GetConfigEntry(configKey);
+        }
+    }
+    uint64_t hash = hashBytes(source.data(), source.size()) ^
+                    hashBytes(identity.data(), identity.size()) * 31;
+    char key[17];
+    snprintf(key, sizeof(key), "%016llx", (unsigned long long) hash);
+    return key;
+}
+
+// 同一网络的旧缓存（模型或ORT版本已变）不会再命中，写入新缓存后删除
+static void removeStaleCache(const std::string &dir, const std::string &netName,
+                             const std::string &keepName) {
+    DIR *d = opendir(dir.c_str());
+    if (d == nullptr) return;
+    std::string prefix = netName + "_";
+    while (struct dirent *entry = readdir(d)) {
+        std::string name = entry->d_name;
+        if (name != keepName && name.compare(0, prefix.size(), prefix) == 0 &&
+            name.size() > 4 && name.compare(name.size() - 4, 4, ".ort") == 0) {
+            unlink((dir + "/" + name).c_str());
+        }
+    }
+    closedir(d);
+}
+
+static std::mutex prepackedMutex;
+static std::map<std::string, std::weak_ptr<OrtPrepackedWeightsContainer>> prepackedWeightsMap;
+
+SharedPrepackedWeights getSharedPrepackedWeights(const std::string &key) {
+    std::lock_guard<std::mutex> lock(prepackedMutex);
+    SharedPrepackedWeights weights = prepackedWeightsMap[key].lock();
+    if (weights) return weights;
+    // 只有过期的条目，顺便清掉
+    for (auto it = prepackedWeightsMap.begin(); it != prepackedWeightsMap.end();) {
+        it = it->second.expired() ? prepackedWeightsMap.erase(it) : std::next(it);
+    }
+    OrtPrepackedWeightsContainer *container = nullptr;
+    Ort::ThrowOnError(Ort::GetApi().CreatePrepackedWeightsContainer(&container));
+    weights = SharedPrepackedWeights(container, [](OrtPrepackedWeightsContainer *p) {
+        Ort::GetApi().ReleasePrepackedWeightsContainer(p);
+    });
+    prepackedWeightsMap[key] = weights;
+    return weights;
+}
+
+static Ort::Session *createSessionFromSource(Ort::Env &env, ModelSource &source,
+                                             Ort::SessionOptions &sessionOptions,
+                                             OrtPrepackedWeightsContainer *prepackedWeights) {
+    if (source.data() == nullptr) {
+        throw std::runtime_error("model source is empty");
+    }
+    bool ortFormat = source.isOrtFormat();
+    if (ortFormat) {
+        // session直接引用映射的flatbuffer，初始化器也不再复制；
+        // 同一模型的各session映射同一个文件，权重共用页缓存
+        sessionOptions.AddConfigEntry("session.use_ort_model_bytes_directly", "1");
+        sessionOptions.AddConfigEntry("session.use_ort_model_bytes_for_initializers", "1");
+    }
+    if (isOrtSharedAllocator()) {
+        sessionOptions.AddConfigEntry("session.use_env_allocators", "1");
+    }
+    Ort::Session *session = prepackedWeights != nullptr ?
+            new Ort::Session(env, source.data(), source.size(), sessionOptions, prepackedWeights) :
+            new Ort::Session(env, source.data(), source.size(), sessionOptions);
+    if (!ortFormat) {
+        source.release();
+    }
+    return session;
+}
+
+static Ort::Session *createSessionCached(Ort::Env &env, ModelSource &source,
+                                         Ort::SessionOptions &sessionOptions, const char *netName,
+                                         GraphOptimizationLevel optLevel, bool &optimized,
+                                         OrtPrepackedWeightsContainer *prepackedWeights) {
+    sessionOptions.SetGraphOptimizationLevel(optLevel);
+    optimized = optLevel != GraphOptimizationLevel::ORT_DISABLE_ALL && !source.isOrtFormat();
+    std::string cacheDir = getModelCacheDir();
+    if (cacheDir.empty() || source.data() == nullptr || source.isOrtFormat()) {
+        return createSessionFromSource(env, source, sessionOptions, prepackedWeights);
+    }
+
+    std::string cacheName = std::string(netName) + "_" + getCacheKey(source, sessionOptions, optLevel) + ".ort";
+    std::string cachePath = cacheDir + "/" + cacheName;
+    if (access(cachePath.c_str(), R_OK) == 0) {
+        ModelSource cached;
+        if (cached.openFile(cachePath)) {
+            try {
+                // 缓存里已是优化后的图，不再重复优化
+                Ort::SessionOptions cachedOptions = sessionOptions.Clone();
+                cachedOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+                Ort::Session *session = createSessionFromSource(env, cached, cachedOptions,
+                                                                prepackedWeights);
+                source = std::move(cached);
+                optimized = false;
+                LOGI("%s: loaded optimized model cache %s", netName, cachePath.c_str());
+                return session;
+            } catch (const Ort::Exception &e) {
+                LOGW("%s: model cache %s unusable, rebuild: %s", netName, cachePath.c_str(),
+                     e.what());
+            }
+        }
+        unlink(cachePath.c_str());
+    }
+
+    // 先写临时文件再rename，其它进程不会读到写了一半的缓存；
+    // 同一进程的多个实例可能并发创建同一网络，临时文件名再带上线程
+    std::string tmpPath = cachePath + ".tmp." + std::to_string(getpid()) + "." +
+                          std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    try {
+        Ort::SessionOptions saveOptions = sessionOptions.Clone();
+        saveOptions.SetOptimizedModelFilePath(tmpPath.c_str());
+        saveOptions.AddConfigEntry("session.save_model_format", "ORT");
+        Ort::Session *session = createSessionFromSource(env, source, saveOptions, prepackedWeights);
+        if (rename(tmpPath.c_str(), cachePath.c_str()) == 0) {
+            LOGI("%s: saved optimized model cache %s", netName, cachePath.c_str());
+            removeStaleCache(cacheDir, netName, cacheName);
+        } else {
+            unlink(tmpPath.c_str());
+        }
+        return session;
+    } catch (const Ort::Exception &e) {
+        // 部分算子无法序列化成ORT格式时，不缓存，照常创建
+        LOGW("%s: save optimized model failed, cache disabled for it: %s", netName, e.what());
+        unlink(tmpPath.c_str());
+        return createSessionFromSource(env, source, sessionOptions, prepackedWeights);
+    }
+}
+
+Ort::Session *createSession(Ort::Env &env, ModelSource &source,
+                            Ort::SessionOptions &sessionOptions, const char *netName,
+                            GraphOptimizationLevel optLevel, ModelLoadTiming *timing,
+                            OrtPrepackedWeightsContainer *prepackedWeights) {
+    double startTime = getCurrentTime();
+    bool optimized = false;
+    Ort::Session *session = createSessionCached(env, source, sessionOptions, netName, optLevel,
+                                                optimized, prepackedWeights);
+    if (timing != nullptr) {
+        timing->sessionMs = getCurrentTime() - startTime;
+        timing->optimized = optimized;
+    }
+    return session;
+}
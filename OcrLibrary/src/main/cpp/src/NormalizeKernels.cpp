@@ -0,0 +1,183 @@
+#include "NormalizeKernels.h"
+#include "OcrUtils.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define OCR_NORMALIZE_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define OCR_NORMALIZE_NEON 1
+#include <arm_neon.h>
+#endif
+
+// 标量参考实现，也处理SIMD内核剩下的尾部像素和非3通道输入
+static void normalizeRowScalar(const unsigned char *src, int pixels, int channels,
+                               const float *scale, const float *bias,
+                               float *dst, size_t planeSize) {
+    for (int x = 0; x < pixels; ++x) {
+        for (int ch = 0; ch < channels; ++ch) {
+            dst[ch * planeSize + x] = (float) src[x * channels + ch] * scale[ch] + bias[ch];
+        }
+    }
+}
+
+#ifdef OCR_NORMALIZE_X86
+
+// 48字节BGR交错数据拆成3个通道各16字节的pshufb掩码：[通道][源向量][字节]
+struct Deinterleave3Masks {
+    unsigned char mask[3][3][16];
+
+    Deinterleave3Masks() {
+        for (int ch = 0; ch < 3; ++ch) {
+            for (int v = 0; v < 3; ++v) {
+                for (int j = 0; j < 16; ++j) {
+                    int i = 3 * j + ch - 16 * v;
+                    mask[ch][v][j] = (i >= 0 && i < 16) ? (unsigned char) i : 0x80;
+                }
+            }
+        }
+    }
+};
+
+static const Deinterleave3Masks deinterleave3Masks;
+
+__attribute__((target("sse4.1")))
+static inline __m128i deinterleave3(__m128i a, __m128i b, __m128i c, int ch) {
+    const __m128i *mask = (const __m128i *) deinterleave3Masks.mask[ch];
+    return _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, _mm_loadu_si128(mask)),
+                                     _mm_shuffle_epi8(b, _mm_loadu_si128(mask + 1))),
+                        _mm_shuffle_epi8(c, _mm_loadu_si128(mask + 2)));
+}
+
+__attribute__((target("sse4.1")))
+static inline void storeNormalized4(__m128i bytes, __m128 scale, __m128 bias, float *out) {
+    __m128 f = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(bytes));
+    _mm_storeu_ps(out, _mm_add_ps(_mm_mul_ps(f, scale), bias));
+}
+
+__attribute__((target("sse4.1")))
+static void normalizeRowSse41(const unsigned char *src, int pixels, int channels,
+                              const float *scale, const float *bias,
+                              float *dst, size_t planeSize) {
+    if (channels != 3) {
+        normalizeRowScalar(src, pixels, channels, scale, bias, dst, planeSize);
+        return;
+    }
+    int x = 0;
+    for (; x + 16 <= pixels; x += 16) {
+        const __m128i *p = (const __m128i *) (src + 3 * x);
+        __m128i a = _mm_loadu_si128(p);
+        __m128i b = _mm_loadu_si128(p + 1);
+        __m128i c = _mm_loadu_si128(p + 2);
+        for (int ch = 0; ch < 3; ++ch) {
+            __m128i bytes = deinterleave3(a, b, c, ch);
+            __m128 vScale = _mm_set1_ps(scale[ch]);
+            __m128 vBias = _mm_set1_ps(bias[ch]);
+            float *out = dst + ch * planeSize + x;
+            storeNormalized4(bytes, vScale, vBias, out);
+            storeNormalized4(_mm_srli_si128(bytes, 4), vScale, vBias, out + 4);
+            storeNormalized4(_mm_srli_si128(bytes, 8), vScale, vBias, out + 8);
+            storeNormalized4(_mm_srli_si128(bytes, 12), vScale, vBias, out + 12);
+        }
+    }
+    normalizeRowScalar(src + 3 * x, pixels - x, 3, scale, bias, dst + x, planeSize);
+}
+
+__attribute__((target("avx2")))
+static inline void storeNormalized8(__m128i bytes, __m256 scale, __m256 bias, float *out) {
+    __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes));
+    _mm256_storeu_ps(out, _mm256_add_ps(_mm256_mul_ps(f, scale), bias));
+}
+
+__attribute__((target("avx2")))
+static void normalizeRowAvx2(const unsigned char *src, int pixels, int channels,
+                             const float *scale, const float *bias,
+                             float *dst, size_t planeSize) {
+    if (channels != 3) {
+        normalizeRowScalar(src, pixels, channels, scale, bias, dst, planeSize);
+        return;
+    }
+    // pshufb在256位下只能在128位lane内搬运，拆通道仍用128位，转换和存储用256位
+    int x = 0;
+    for (; x + 16 <= pixels; x += 16) {
+        const __m128i *p = (const __m128i *) (src + 3 * x);
+        __m128i a = _mm_loadu_si128(p);
+        __m128i b = _mm_loadu_si128(p + 1);
+        __m128i c = _mm_loadu_si128(p + 2);
+        for (int ch = 0; ch < 3; ++ch) {
+            __m128i bytes = deinterleave3(a, b, c, ch);
+            __m256 vScale = _mm256_set1_ps(scale[ch]);
+            __m256 vBias = _mm256_set1_ps(bias[ch]);
+            float *out = dst + ch * planeSize + x;
+            storeNormalized8(bytes, vScale, vBias, out);
+            storeNormalized8(_mm_srli_si128(bytes, 8), vScale, vBias, out + 8);
+        }
+    }
+    normalizeRowScalar(src + 3 * x, pixels - x, 3, scale, bias, dst + x, planeSize);
+}
+
+#endif //OCR_NORMALIZE_X86
+
+#ifdef OCR_NORMALIZE_NEON
+
+static inline void storeNormalized8(uint16x8_t u16, float32x4_t scale, float32x4_t bias,
+                                    float *out) {
+    float32x4_t lo = vcvtq_f32_u32(vmovl_u16(vget_low_u16(u16)));
+    float32x4_t hi = vcvtq_f32_u32(vmovl_u16(vget_high_u16(u16)));
+    vst1q_f32(out, vaddq_f32(vmulq_f32(lo, scale), bias));
+    vst1q_f32(out + 4, vaddq_f32(vmulq_f32(hi, scale), bias));
+}
+
+// arm64-v8a 必有NEON，armeabi-v7a 由NDK默认开启，编译期决定即可
+static void normalizeRowNeon(const unsigned char *src, int pixels, int channels,
+                             const float *scale, const float *bias,
+                             float *dst, size_t planeSize) {
+    if (channels != 3) {
+        normalizeRowScalar(src, pixels, channels, scale, bias, dst, planeSize);
+        return;
+    }
+    int x = 0;
+    for (; x + 16 <= pixels; x += 16) {
+        // vld3q_u8直接把BGR交错数据拆成三个通道
+        uint8x16x3_t px = vld3q_u8(src + 3 * x);
+        for (int ch = 0; ch < 3; ++ch) {
+            float32x4_t vScale = vdupq_n_f32(scale[ch]);
+            float32x4_t vBias = vdupq_n_f32(bias[ch]);
+            float *out = dst + ch * planeSize + x;
+            storeNormalized8(vmovl_u8(vget_low_u8(px.val[ch])), vScale, vBias, out);
+            storeNormalized8(vmovl_u8(vget_high_u8(px.val[ch])), vScale, vBias, out + 8);
+        }
+    }
+    normalizeRowScalar(src + 3 * x, pixels - x, 3, scale, bias, dst + x, planeSize);
+}
+
+#endif //OCR_NORMALIZE_NEON
+
+static std::vector<NormalizeKernel> detectNormalizeKernels() {
+    std::vector<NormalizeKernel> kernels = {{"scalar", normalizeRowScalar}};
+#ifdef OCR_NORMALIZE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.1")) {
+        kernels.push_back({"sse4.1", normalizeRowSse41});
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.push_back({"avx2", normalizeRowAvx2});
+    }
+#elif defined(OCR_NORMALIZE_NEON)
+    kernels.push_back({"neon", normalizeRowNeon});
+#endif
+    return kernels;
+}
+
+const std::vector<NormalizeKernel> &getNormalizeKernels() {
+    static const std::vector<NormalizeKernel> kernels = detectNormalizeKernels();
+    return kernels;
+}
+
+const NormalizeKernel &getNormalizeKernel() {
+    static const NormalizeKernel &kernel = []() -> const NormalizeKernel & {
+        const NormalizeKernel &best = getNormalizeKernels().back();
+        LOGI("substractMeanNormalize kernel: %s", best.name);
+        return best;
+    }();
+    return kernel;
+}
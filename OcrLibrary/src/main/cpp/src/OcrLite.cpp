@@ -1,37 +1,429 @@
+#ifdef __ANDROID__
 #include <android/asset_manager.h>
 #include <android/asset_manager_jni.h>
+#endif
 #include "OcrLite.h"
 #include "OcrUtils.h"
 #include "LayoutNet.h"
+#include "OcrTrace.h"
+#include "ModelSource.h"
+#include <memory>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static const char *netNames[NET_COUNT] = {"DbNet", "AngleNet", "CrnnNet", "LayoutNet"};
 
 OcrLite::OcrLite() {}
 
-OcrLite::~OcrLite() {}
+OcrLite::~OcrLite() {
+    {
+        std::lock_guard<std::mutex> lock(netMutex);
+        stopEvict = true;
+    }
+    evictCondition.notify_all();
+    if (evictThread.joinable()) evictThread.join();
+    // 后台创建中的session要先结束，否则会写进已销毁的网络；deferred的尚未执行，不必等
+    for (auto &future : netFutures) {
+        if (future.valid() && future.wait_for(std::chrono::seconds(0)) != std::future_status::deferred) {
+            future.wait();
+        }
+    }
+#ifdef __ANDROID__
+    JNIEnv *env = nullptr;
+    if (assetManagerRef != nullptr && javaVM != nullptr &&
+        javaVM->GetEnv((void **) &env, JNI_VERSION_1_4) == JNI_OK) {
+        env->DeleteGlobalRef(assetManagerRef);
+    }
+#endif
+}
+
+void OcrLite::setNumThread(int numOfThread) {
+    // ORT线程池创建后预算固定，OpenCV/OpenMP仍按本次请求的数设置
+    setOrtThreadBudget(numOfThread);
+    int budget = resolveThreadBudget(numOfThread);
+    cv::setNumThreads(budget);
+#ifdef _OPENMP
+    omp_set_num_threads(budget);
+#endif
+    LOGI("thread budget: %d (ORT pool %d)", budget, getOrtThreadBudget());
+}
+
+void OcrLite::setInitMode(InitMode mode) {
+    initMode = mode;
+}
+
+void OcrLite::setWarmup(const WarmupConfig &config) {
+    warmupConfig = config;
+}
+
+std::vector<NetInitTiming> OcrLite::getInitTiming() {
+    const ModelLoadTiming *loadTimings[NET_COUNT] = {&dbNet.getLoadTiming(), &angleNet.getLoadTiming(),
+                                                     &crnnNet.getLoadTiming(), &layoutNet.getLoadTiming()};
+    std::lock_guard<std::mutex> lock(netMutex);
+    std::vector<NetInitTiming> timings;
+    for (int i = 0; i < NET_COUNT; ++i) {
+        const ModelLoadTiming &load = *loadTimings[i];
+        timings.push_back({netNames[i], netLoadMs[i], load.readMs, load.sessionMs, load.optimized,
+                           load.keysMs, netWarmupMs[i], netReadyMs[i]});
+    }
+    return timings;
+}
+
+NetStatus OcrLite::getNetStatus(NetIndex net) const {
+    return static_cast<NetStatus>(netStatus[net].load());
+}
+
+bool OcrLite::isOcrReady() const {
+    return getNetStatus(NET_DB) == NetStatus::Ready && getNetStatus(NET_ANGLE) == NetStatus::Ready &&
+           getNetStatus(NET_CRNN) == NetStatus::Ready;
+}
+
+bool OcrLite::isLayoutReady() const {
+    return getNetStatus(NET_LAYOUT) == NetStatus::Ready;
+}
+
+void OcrLite::launchNet(NetIndex net, std::launch policy, bool warmUp) {
+    auto task = [this, net, warmUp]() {
+        const char *name = netNames[net];
+        TraceSpan span(name);
+        netStatus[net] = (int) NetStatus::Loading;
+        double startTime = getCurrentTime();
+        size_t rssBefore = getResidentBytes();
+        try {
+            netLoaders[net]();
+        } catch (...) {
+            netStatus[net] = (int) NetStatus::Failed;
+            LOGE("init %s failed", name);
+            throw;
+        }
+        double loadEndTime = getCurrentTime();
+        if (warmUp) {
+            // 预热失败不影响网络可用，真实请求照常执行
+            try {
+                TraceSpan warmupSpan("OcrLite::warmUpNet");
+                warmUpNet(net);
+            } catch (const std::exception &e) {
+                LOGW("warm-up %s failed: %s", name, e.what());
+            }
+        }
+        double readyTime = getCurrentTime();
+        long loadRss = (long) getResidentBytes() - (long) rssBefore;
+        {
+            std::lock_guard<std::mutex> lock(netMutex);
+            netLoadRss[net] = loadRss;
+            netArenaRss[net] = 0;
+            // 预热已经跑过一次，arena增长计入了loadRss
+            netUsedSinceLoad[net] = warmUp;
+            // time-to-ready只记第一次加载，空闲卸载后的重新加载只更新loadMs
+            if (netLoadCount[net] == 0) netReadyMs[net] = readyTime - initStartTime;
+            netLoadCount[net]++;
+            netLastUsed[net] = readyTime;
+            netLoadMs[net] = loadEndTime - startTime;
+            netWarmupMs[net] = warmUp ? readyTime - loadEndTime : 0;
+        }
+        netStatus[net] = (int) NetStatus::Ready;
+        LOGI("init %s done (load %fms, warm-up %fms, rss %+.1fMB)", name, loadEndTime - startTime,
+             warmUp ? readyTime - loadEndTime : 0.0, loadRss / 1048576.0);
+    };
+    netStatus[net] = (int) NetStatus::Unloaded;
+    // deferred在第一次get()时于调用线程执行
+    netFutures[net] = std::async(policy, task).share();
+}
+
+void OcrLite::warmUpNet(NetIndex net) {
+    const cv::Scalar white(255, 255, 255);
+    NetTiming timing;
+    switch (net) {
+        case NET_DB: {
+            int side = warmupConfig.dbSideLen;
+            cv::Mat blank(side, side, CV_8UC3, white);
+            ScaleParam scale = getScaleParam(blank, side);
+            dbNet.getTextBoxes(blank, scale, 0.3f, 0.15f, 1.6f, timing);
+            break;
+        }
+        case NET_ANGLE: {
+            std::vector<cv::Mat> parts = {cv::Mat(48, 192, CV_8UC3, white)};
+            angleNet.getAngles(parts, true, false, timing);
+            break;
+        }
+        case NET_CRNN: {
+            std::vector<cv::Mat> parts;
+            for (int width : warmupConfig.crnnWidths) {
+                if (width > 0) parts.emplace_back(48, width, CV_8UC3, white);
+            }
+            crnnNet.getTextLines(parts, timing);
+            break;
+        }
+        case NET_LAYOUT: {
+            for (int size : layoutNet.getCandidateInputSizes()) {
+                cv::Mat blank(size, layoutNet.isRectInput() ? size * 210 / 297 : size, CV_8UC3, white);
+                layoutNet.getLayoutBoxes(blank, 0.5f, size);
+            }
+            // 指定边长时跳过级联，快速模型另跑一次；空白页总能通过放行条件
+            if (layoutNet.hasCascade()) {
+                cv::Mat blank(1024, layoutNet.isRectInput() ? 1024 * 210 / 297 : 1024, CV_8UC3, white);
+                layoutNet.getLayoutBoxes(blank, 0.5f);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void OcrLite::startNets() {
+    std::lock_guard<std::mutex> lock(netMutex);
+    initStartTime = getCurrentTime();
+    for (int i = 0; i < NET_COUNT; ++i) {
+        NetIndex net = static_cast<NetIndex>(i);
+        if (initMode == InitMode::Lazy) {
+            // 不创建future，由NetLease在第一次使用时发起
+            netStatus[net] = (int) NetStatus::Unloaded;
+            netFutures[net] = std::shared_future<void>();
+        } else {
+            launchNet(net, std::launch::async, warmupConfig.enabled);
+        }
+    }
+}
+
+void OcrLite::waitNet(NetIndex net) {
+    std::shared_future<void> future;
+    {
+        std::lock_guard<std::mutex> lock(netMutex);
+        future = netFutures[net];
+    }
+    if (future.valid()) future.get();
+}
 
+void OcrLite::unloadNet(NetIndex net) {
+    size_t rssBefore = getResidentBytes();
+    switch (net) {
+        case NET_DB:
+            dbNet.releaseModel();
+            break;
+        case NET_ANGLE:
+            angleNet.releaseModel();
+            break;
+        case NET_CRNN:
+            crnnNet.releaseModel();
+            break;
+        case NET_LAYOUT:
+            layoutNet.releaseModel();
+            break;
+        default:
+            return;
+    }
+    netFutures[net] = std::shared_future<void>();
+    netStatus[net] = (int) NetStatus::Unloaded;
+    LOGI("unload idle %s (rss %+.1fMB)", netNames[net],
+         ((long) getResidentBytes() - (long) rssBefore) / 1048576.0);
+}
+
+std::string formatNetMemory(const NetMemoryInfo &info) {
+    static const char *statusNames[] = {"unloaded", "loading", "ready", "failed"};
+    char line[256];
+    snprintf(line, sizeof(line), "%s %s model=%.1fMB load=%+.1fMB arena=%+.1fMB loads=%d idle=%.1fs",
+             info.name, statusNames[(int) info.status], info.modelBytes / 1048576.0,
+             info.loadRssBytes / 1048576.0, info.arenaRssBytes / 1048576.0, info.loadCount,
+             info.idleMs / 1000.0);
+    return line;
+}
+
+std::string formatInitTiming(const NetInitTiming &timing) {
+    char line[256];
+    snprintf(line, sizeof(line),
+             "%s load=%.1fms(read=%.1fms session=%.1fms%s keys=%.1fms) warmup=%.1fms ready=%.1fms",
+             timing.name, timing.loadMs, timing.readMs, timing.sessionMs,
+             timing.optimized ? "" : " cached", timing.keysMs, timing.warmupMs, timing.readyMs);
+    return line;
+}
+
+OcrLite::NetLease::NetLease(OcrLite &lite, NetIndex net) : lite(lite), net(net) {
+    std::shared_future<void> future;
+    {
+        std::lock_guard<std::mutex> lock(lite.netMutex);
+        lite.netUsers[net]++;
+        // Lazy模式首次使用，或空闲卸载后再次使用
+        if (!lite.netFutures[net].valid() && lite.netLoaders[net]) {
+            lite.launchNet(net, std::launch::deferred, false);
+        }
+        future = lite.netFutures[net];
+    }
+    try {
+        if (future.valid()) future.get();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(lite.netMutex);
+        lite.netUsers[net]--;
+        throw;
+    }
+    std::lock_guard<std::mutex> lock(lite.netMutex);
+    measure = !lite.netUsedSinceLoad[net];
+    if (measure) {
+        lite.netUsedSinceLoad[net] = true;
+        rssBefore = getResidentBytes();
+    }
+}
+
+OcrLite::NetLease::~NetLease() {
+    long arenaRss = measure ? (long) getResidentBytes() - (long) rssBefore : 0;
+    std::lock_guard<std::mutex> lock(lite.netMutex);
+    lite.netUsers[net]--;
+    lite.netLastUsed[net] = getCurrentTime();
+    if (measure) {
+        lite.netArenaRss[net] = (std::max)(arenaRss, 0L);
+    }
+}
+
+void OcrLite::setIdleTimeout(double seconds) {
+    {
+        std::lock_guard<std::mutex> lock(netMutex);
+        idleTimeoutMs = seconds > 0 ? seconds * 1000 : 0;
+        if (idleTimeoutMs > 0 && !evictThread.joinable()) {
+            evictThread = std::thread(&OcrLite::evictIdleNets, this);
+        }
+    }
+    evictCondition.notify_all();
+}
+
+void OcrLite::evictIdleNets() {
+    std::unique_lock<std::mutex> lock(netMutex);
+    while (!stopEvict) {
+        if (idleTimeoutMs <= 0) {
+            evictCondition.wait(lock);
+            continue;
+        }
+        // 检查粒度为超时的1/4，最长1秒
+        double interval = (std::min)(idleTimeoutMs / 4, 1000.0);
+        evictCondition.wait_for(lock, std::chrono::duration<double, std::milli>(interval));
+        if (stopEvict || idleTimeoutMs <= 0) continue;
+        double now = getCurrentTime();
+        for (int i = 0; i < NET_COUNT; ++i) {
+            NetIndex net = static_cast<NetIndex>(i);
+            if (getNetStatus(net) == NetStatus::Ready && netUsers[net] == 0 &&
+                now - netLastUsed[net] >= idleTimeoutMs) {
+                unloadNet(net);
+            }
+        }
+    }
+}
+
+std::vector<NetMemoryInfo> OcrLite::getNetMemory() {
+    size_t modelBytes[NET_COUNT] = {dbNet.getModelBytes(), angleNet.getModelBytes(),
+                                    crnnNet.getModelBytes(), layoutNet.getModelBytes()};
+    std::lock_guard<std::mutex> lock(netMutex);
+    double now = getCurrentTime();
+    std::vector<NetMemoryInfo> infos;
+    for (int i = 0; i < NET_COUNT; ++i) {
+        NetIndex net = static_cast<NetIndex>(i);
+        NetStatus status = getNetStatus(net);
+        infos.push_back({netNames[i], status, modelBytes[i], netLoadRss[i], netArenaRss[i],
+                         netLoadCount[i],
+                         status == NetStatus::Ready && netUsers[i] == 0 ? now - netLastUsed[i] : 0});
+    }
+    return infos;
+}
+
+#ifdef __ANDROID__
 void OcrLite::init(JNIEnv *jniEnv, jobject assetManager, int numThread, std::string detName,
                    std::string clsName, std::string recName, std::string keysName, std::string layoutName) {
-    AAssetManager *mgr = AAssetManager_fromJava(jniEnv, assetManager);
+    jniEnv->GetJavaVM(&javaVM);
+    assetManagerRef = jniEnv->NewGlobalRef(assetManager);
+    AAssetManager *mgr = AAssetManager_fromJava(jniEnv, assetManagerRef);
     if (mgr == NULL) {
         LOGE(" %s", "AAssetManager==NULL");
     }
+    setNumThread(numThread);
 
-    Logger("--- Init DbNet ---\n");
-    dbNet.setNumThread(numThread);
-    dbNet.initModel(mgr, detName);
+    netLoaders[NET_DB] = [=]() {
+        Logger("--- Init DbNet ---\n");
+        dbNet.setNumThread(numThread);
+        dbNet.initModel(mgr, detName);
+    };
+    netLoaders[NET_ANGLE] = [=]() {
+        Logger("--- Init AngleNet ---\n");
+        angleNet.setNumThread(numThread);
+        angleNet.initModel(mgr, clsName);
+    };
+    netLoaders[NET_CRNN] = [=]() {
+        Logger("--- Init CrnnNet ---\n");
+        crnnNet.setNumThread(numThread);
+        crnnNet.initModel(mgr, recName, keysName);
+    };
+    netLoaders[NET_LAYOUT] = [=]() {
+        Logger("--- Init LayoutNet ---\n");
+        layoutNet.setNumThread(numThread);
+        layoutNet.initModel(mgr, layoutName);
+    };
+    startNets();
+    if (initMode == InitMode::Eager) {
+        for (int i = 0; i < NET_COUNT; ++i) waitNet(static_cast<NetIndex>(i));
+        LOGI("初始化完成!");
+    }
+}
+#endif
 
-    Logger("--- Init AngleNet ---\n");
-    angleNet.setNumThread(numThread);
-    angleNet.initModel(mgr, clsName);
+void OcrLite::init(int numThread, std::string detPath, std::string clsPath, std::string recPath,
+                   std::string keysPath, std::string layoutPath) {
+    setNumThread(numThread);
 
-    Logger("--- Init CrnnNet ---\n");
-    crnnNet.setNumThread(numThread);
-    crnnNet.initModel(mgr, recName, keysName);
+    netLoaders[NET_DB] = [=]() {
+        Logger("--- Init DbNet ---\n");
+        dbNet.setNumThread(numThread);
+        dbNet.initModel(detPath);
+    };
+    netLoaders[NET_ANGLE] = [=]() {
+        Logger("--- Init AngleNet ---\n");
+        angleNet.setNumThread(numThread);
+        angleNet.initModel(clsPath);
+    };
+    netLoaders[NET_CRNN] = [=]() {
+        Logger("--- Init CrnnNet ---\n");
+        crnnNet.setNumThread(numThread);
+        crnnNet.initModel(recPath, keysPath);
+    };
+    netLoaders[NET_LAYOUT] = [=]() {
+        Logger("--- Init LayoutNet ---\n");
+        layoutNet.setNumThread(numThread);
+        layoutNet.initModel(layoutPath);
+    };
+    startNets();
+    if (initMode == InitMode::Eager) {
+        for (int i = 0; i < NET_COUNT; ++i) waitNet(static_cast<NetIndex>(i));
+        LOGI("初始化完成!");
+    }
+}
 
-    Logger("--- Init LayoutNet ---\n");
-    layoutNet.setNumThread(numThread);
-    layoutNet.initModel(mgr, layoutName);
+void OcrLite::setLayoutInputSize(int size) {
+    layoutNet.setInputSize(size);
+}
+
+void OcrLite::setLayoutRectInput(bool enabled) {
+    layoutNet.setRectInput(enabled);
+}
+
+void OcrLite::setLayoutCascade(const std::string &fastModel, const LayoutCascadeConfig &config) {
+    layoutNet.setCascade(fastModel, config);
+}
 
-    LOGI("初始化完成!");
+void OcrLite::setCacheDir(const std::string &dir) {
+    setModelCacheDir(dir);
+}
+
+void OcrLite::setProfilePrefix(const std::string &prefix) {
+    dbNet.setProfiling(prefix.empty() ? prefix : prefix + "_det");
+    angleNet.setProfiling(prefix.empty() ? prefix : prefix + "_cls");
+    crnnNet.setProfiling(prefix.empty() ? prefix : prefix + "_rec");
+    layoutNet.setProfiling(prefix.empty() ? prefix : prefix + "_layout");
+}
+
+std::vector<std::string> OcrLite::endProfiling() {
+    std::vector<std::string> files;
+    for (const std::string &file : {dbNet.endProfiling(), angleNet.endProfiling(),
+                                    crnnNet.endProfiling(), layoutNet.endProfiling()}) {
+        if (!file.empty()) files.push_back(file);
+    }
+    return files;
 }
 
 /*void OcrLite::initLogger(bool isDebug) {
@@ -49,21 +441,132 @@ void OcrLite::Logger(const char *format, ...) {
     free(buffer);
 }*/
 
-std::vector<cv::Mat> getPartImages(cv::Mat &src, std::vector<TextBox> &textBoxes) {
-    std::vector<cv::Mat> partImages;
-    for (int i = 0; i < textBoxes.size(); ++i) {
-        cv::Mat partImg = getRotateCropImage(src, textBoxes[i].boxPoint);
-        partImages.emplace_back(partImg);
+// 文本框四个顶点，作为方向/识别缓存的键
+static std::vector<int> textBoxKey(const TextBox &textBox) {
+    std::vector<int> key;
+    key.reserve(9);
+    for (const auto &point : textBox.boxPoint) {
+        key.push_back(point.x);
+        key.push_back(point.y);
+    }
+    return key;
+}
+
+void OcrLite::recognizeTextBoxes(cv::Mat &src, std::vector<TextBox> &textBoxes, bool doAngle,
+                                 bool mostAngle, PageCache *cache, PipelineTiming &timing,
+                                 std::vector<Angle> &angles, std::vector<TextLine> &textLines) {
+    StageTimer timer;
+    const size_t count = textBoxes.size();
+    std::vector<cv::Mat> partImages(count);
+    std::vector<std::vector<int>> keys(count);
+    // 只裁剪真正要送进网络的框
+    auto partImage = [&](size_t i) -> cv::Mat & {
+        if (partImages[i].empty()) partImages[i] = getRotateCropImage(src, textBoxes[i].boxPoint);
+        return partImages[i];
+    };
+
+    Logger("---------- step: angleNet getAngles ----------");
+    // 缓存的是多数票之前的结果，合并后统一投票，与整页重跑一致
+    angles.assign(count, Angle{-1, 0.f, 0.0});
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < count; ++i) {
+        if (cache != nullptr) keys[i] = textBoxKey(textBoxes[i]);
+        // 不做方向分类时不触碰AngleNet，它可以保持未加载
+        if (!doAngle) continue;
+        if (cache != nullptr) {
+            auto hit = cache->angles.find(keys[i]);
+            if (hit != cache->angles.end()) {
+                angles[i] = hit->second;
+                angles[i].time = 0;
+                continue;
+            }
+        }
+        pending.push_back(i);
+    }
+    if (!pending.empty()) {
+        std::vector<cv::Mat> parts;
+        parts.reserve(pending.size());
+        for (size_t i : pending) parts.push_back(partImage(i));
+        timer.lap(timing.dbNet.crop, "getPartImages");
+        std::vector<Angle> pendingAngles;
+        {
+            NetLease lease(*this, NET_ANGLE);
+            pendingAngles = angleNet.getAngles(parts, true, false, timing.angleNet);
+        }
+        for (size_t k = 0; k < pending.size(); ++k) {
+            angles[pending[k]] = pendingAngles[k];
+            if (cache != nullptr) cache->angles[keys[pending[k]]] = pendingAngles[k];
+        }
+        timer.restart();
+    }
+    if (doAngle && mostAngle) {
+        AngleNet::applyMostAngle(angles);
+        timer.lap(timing.angleNet.postprocess, "AngleNet::mostAngle");
+    }
+
+    //Log Angles
+    for (int i = 0; i < angles.size(); ++i) {
+        Logger("angle[%d][index(%d), score(%f), time(%fms)]", i, angles[i].index, angles[i].score, angles[i].time);
+    }
+
+    // 框和最终方向都没变才沿用缓存的文字
+    textLines.assign(count, TextLine{"", {}, 0.0});
+    pending.clear();
+    for (size_t i = 0; i < count; ++i) {
+        if (cache != nullptr) {
+            keys[i].push_back(angles[i].index);
+            auto hit = cache->textLines.find(keys[i]);
+            if (hit != cache->textLines.end()) {
+                textLines[i] = hit->second;
+                textLines[i].time = 0;
+                continue;
+            }
+        }
+        pending.push_back(i);
+    }
+    timer.restart();
+    for (size_t i : pending) partImage(i);
+    timer.lap(timing.dbNet.crop, "getPartImages");
+
+    //Rotate partImgs
+    std::vector<cv::Mat> textParts;
+    textParts.reserve(pending.size());
+    for (size_t i : pending) {
+        textParts.push_back(angles[i].index == 1 ? matRotateClockWise180(partImages[i]) : partImages[i]);
+    }
+    timer.lap(timing.angleNet.postprocess, "rotatePartImages");
+
+    Logger("---------- step: crnnNet getTextLine ----------");
+    if (!textParts.empty()) {
+        std::vector<TextLine> pendingLines;
+        {
+            NetLease lease(*this, NET_CRNN);
+            pendingLines = crnnNet.getTextLines(textParts, timing.crnnNet);
+        }
+        for (size_t k = 0; k < pending.size(); ++k) {
+            textLines[pending[k]] = pendingLines[k];
+            if (cache != nullptr) cache->textLines[keys[pending[k]]] = pendingLines[k];
+        }
     }
-    return partImages;
 }
 
 OcrResult OcrLite::detect(cv::Mat &src, cv::Rect &originRect, ScaleParam &scale,
                           float boxScoreThresh, float boxThresh,
                           float unClipRatio, bool doAngle, bool mostAngle) {
+    return runDetect(src, originRect, scale, boxScoreThresh, boxThresh, unClipRatio,
+                     doAngle, mostAngle, nullptr, false);
+}
+
+OcrResult OcrLite::runDetect(cv::Mat &src, cv::Rect &originRect, ScaleParam &scale,
+                             float boxScoreThresh, float boxThresh, float unClipRatio,
+                             bool doAngle, bool mostAngle, PageCache *cache, bool refilter) {
+    TraceSpan span(refilter ? "OcrLite::refilter" : "OcrLite::detect");
 
+    PipelineTiming timing;
+    StageTimer timer;
     cv::Mat textBoxPaddingImg = src.clone();
     int thickness = getThickness(src);
+    timer.lap(timing.dbNet.render, "cloneSrc");
 
     Logger("=====Start detect=====");
     Logger("ScaleParam(sw:%d,sh:%d,dw:%d,dh:%d,%f,%f)", scale.srcWidth, scale.srcHeight,
@@ -72,7 +575,16 @@ OcrResult OcrLite::detect(cv::Mat &src, cv::Rect &originRect, ScaleParam &scale,
 
     Logger("---------- step: dbNet getTextBoxes ----------");
     double startTime = getCurrentTime();
-    std::vector<TextBox> textBoxes = dbNet.getTextBoxes(src, scale, boxScoreThresh, boxThresh, unClipRatio);
+    std::vector<TextBox> textBoxes;
+    if (refilter) {
+        // 不需要session，也就不占用/加载DbNet
+        textBoxes = dbNet.refilterTextBoxes(cache->dbRaw, boxScoreThresh, boxThresh, unClipRatio,
+                                            timing.dbNet);
+    } else {
+        NetLease lease(*this, NET_DB);
+        textBoxes = dbNet.getTextBoxes(src, scale, boxScoreThresh, boxThresh, unClipRatio, timing.dbNet,
+                                       cache != nullptr ? &cache->dbRaw : nullptr);
+    }
     Logger("TextBoxesSize(%ld)", textBoxes.size());
     double endDbNetTime = getCurrentTime();
     double dbNetTime = endDbNetTime - startTime;
@@ -89,29 +601,14 @@ OcrResult OcrLite::detect(cv::Mat &src, cv::Rect &originRect, ScaleParam &scale,
     }
 
     Logger("---------- step: drawTextBoxes ----------");
+    timer.restart();
     drawTextBoxes(textBoxPaddingImg, textBoxes, thickness);
+    timer.lap(timing.dbNet.render, "drawTextBoxes");
 
-    //---------- getPartImages ----------
-    std::vector<cv::Mat> partImages = getPartImages(src, textBoxes);
-
-    Logger("---------- step: angleNet getAngles ----------");
     std::vector<Angle> angles;
-    angles = angleNet.getAngles(partImages, doAngle, mostAngle);
-
-    //Log Angles
-    for (int i = 0; i < angles.size(); ++i) {
-        Logger("angle[%d][index(%d), score(%f), time(%fms)]", i, angles[i].index, angles[i].score, angles[i].time);
-    }
-
-    //Rotate partImgs
-    for (int i = 0; i < partImages.size(); ++i) {
-        if (angles[i].index == 1) {
-            partImages.at(i) = matRotateClockWise180(partImages[i]);
-        }
-    }
+    std::vector<TextLine> textLines;
+    recognizeTextBoxes(src, textBoxes, doAngle, mostAngle, cache, timing, angles, textLines);
 
-    Logger("---------- step: crnnNet getTextLine ----------");
-    std::vector<TextLine> textLines = crnnNet.getTextLines(partImages);
     //Log TextLines
     for (int i = 0; i < textLines.size(); ++i) {
         Logger("textLine[%d](%s)", i, textLines[i].text.c_str());
@@ -147,27 +644,138 @@ OcrResult OcrLite::detect(cv::Mat &src, cv::Rect &originRect, ScaleParam &scale,
     Logger("FullDetectTime(%fms)", fullTime);
 
     //cropped to original size
+    timer.restart();
     cv::Mat textBoxImg;
     if (originRect.x > 0 && originRect.y > 0) {
         textBoxPaddingImg(originRect).copyTo(textBoxImg);
     } else {
         textBoxImg = textBoxPaddingImg;
     }
+    timer.lap(timing.dbNet.render, "cropBoxImg");
 
     std::string strRes;
     for (int i = 0; i < textBlocks.size(); ++i) {
         strRes.append(textBlocks[i].text);
         strRes.append("\n");
     }
+    timer.lap(timing.crnnNet.postprocess, "joinText");
+
+    return OcrResult{dbNetTime, textBlocks, textBoxImg, fullTime, strRes, timing};
+}
+
+OcrResult OcrLite::detect(cv::Mat &src, int padding, int maxSideLen,
+                          float boxScoreThresh, float boxThresh,
+                          float unClipRatio, bool doAngle, bool mostAngle, int handle) {
+    int originMaxSide = (std::max)(src.cols, src.rows);
+    int resize;
+    if (maxSideLen <= 0 || maxSideLen > originMaxSide) {
+        resize = originMaxSide;
+    } else {
+        resize = maxSideLen;
+    }
+    resize += 2 * padding;
+    cv::Rect paddingRect(padding, padding, src.cols, src.rows);
+    cv::Mat paddingSrc = makePadding(src, padding);
+    //按比例缩小图像，减少文字分割时间
+    ScaleParam s = getScaleParam(paddingSrc, resize);
+    std::shared_ptr<PageCache> page = getPage(handle, true);
+    if (!page) {
+        return detect(paddingSrc, paddingRect, s, boxScoreThresh, boxThresh,
+                      unClipRatio, doAngle, mostAngle);
+    }
+    // 新的一次检测：概率图与框级缓存都换掉，版面部分保留
+    page->paddingSrc = paddingSrc;
+    page->originRect = paddingRect;
+    page->angles.clear();
+    page->textLines.clear();
+    page->hasDbRaw = false;
+    page->dbRaw.probMap.release();
+    OcrResult result = runDetect(paddingSrc, paddingRect, s, boxScoreThresh, boxThresh,
+                                 unClipRatio, doAngle, mostAngle, page.get(), false);
+    page->hasDbRaw = !page->dbRaw.probMap.empty();
+    return result;
+}
+
+void OcrLite::setRefilterCache(int capacity) {
+    std::lock_guard<std::mutex> lock(pageMutex);
+    pageCapacity = (std::max)(0, capacity);
+    if (pageCapacity == 0) pages.clear();
+    while ((int) pages.size() > pageCapacity) {
+        auto oldest = pages.begin();
+        for (auto it = pages.begin(); it != pages.end(); ++it) {
+            if (it->second->lastUsed < oldest->second->lastUsed) oldest = it;
+        }
+        pages.erase(oldest);
+    }
+}
 
-    return OcrResult{dbNetTime, textBlocks, textBoxImg, fullTime, strRes};
+void OcrLite::releasePage(int handle) {
+    std::lock_guard<std::mutex> lock(pageMutex);
+    pages.erase(handle);
 }
 
-LayoutResult OcrLite::detectLayout(cv::Mat &src, float boxScoreThresh) {
+std::shared_ptr<OcrLite::PageCache> OcrLite::getPage(int handle, bool create) {
+    std::lock_guard<std::mutex> lock(pageMutex);
+    if (handle < 0 || pageCapacity == 0) return nullptr;
+    auto it = pages.find(handle);
+    if (it == pages.end()) {
+        if (!create) return nullptr;
+        // 页数通常只有几页到几十页，线性找最久未用的即可
+        while ((int) pages.size() >= pageCapacity) {
+            auto oldest = pages.begin();
+            for (auto p = pages.begin(); p != pages.end(); ++p) {
+                if (p->second->lastUsed < oldest->second->lastUsed) oldest = p;
+            }
+            Logger("refilter cache full, drop page %d", oldest->first);
+            pages.erase(oldest);
+        }
+        it = pages.emplace(handle, std::make_shared<PageCache>()).first;
+    }
+    it->second->lastUsed = ++pageClock;
+    return it->second;
+}
+
+OcrResult OcrLite::refilter(int handle, float boxScoreThresh, float boxThresh,
+                            float unClipRatio, bool doAngle, bool mostAngle) {
+    std::shared_ptr<PageCache> page = getPage(handle, false);
+    if (!page || !page->hasDbRaw) {
+        LOGW("refilter: no cached detection for page %d", handle);
+        return OcrResult{};
+    }
+    return runDetect(page->paddingSrc, page->originRect, page->dbRaw.scale, boxScoreThresh,
+                     boxThresh, unClipRatio, doAngle, mostAngle, page.get(), true);
+}
+
+LayoutResult OcrLite::refilterLayout(int handle, float boxScoreThresh) {
+    std::shared_ptr<PageCache> page = getPage(handle, false);
+    if (!page || !page->hasLayoutRaw) {
+        LOGW("refilterLayout: no cached layout for page %d", handle);
+        return LayoutResult{};
+    }
+    TraceSpan span("OcrLite::refilterLayout");
+    double startTime = getCurrentTime();
+    LayoutResult result = layoutNet.refilter(page->layoutRaw, boxScoreThresh);
+    Logger("Layout Refilter Time(%fms)", getCurrentTime() - startTime);
+    return result;
+}
+
+LayoutResult OcrLite::detectLayout(cv::Mat &src, float boxScoreThresh, int handle) {
+    TraceSpan span("OcrLite::detectLayout");
     Logger("=====Start Layout Detection=====");
+    std::shared_ptr<PageCache> page = getPage(handle, true);
+    NetLease lease(*this, NET_LAYOUT);
     double startTime = getCurrentTime();
 
-    LayoutResult result = layoutNet.getLayoutBoxes(src, boxScoreThresh);
+    LayoutResult result;
+    if (page) {
+        // 推理失败时getLayoutBoxes不写raw，清空后按是否写入判断缓存是否有效，避免留着上一张图的输出
+        page->layoutRaw.shape.clear();
+        page->layoutRaw.data.clear();
+        result = layoutNet.getLayoutBoxes(src, boxScoreThresh, 0, &page->layoutRaw);
+        page->hasLayoutRaw = !page->layoutRaw.shape.empty();
+    } else {
+        result = layoutNet.getLayoutBoxes(src, boxScoreThresh);
+    }
 
     double endTime = getCurrentTime();
     double fullTime = endTime - startTime;
@@ -176,3 +784,48 @@ LayoutResult OcrLite::detectLayout(cv::Mat &src, float boxScoreThresh) {
 
     return result;
 }
+
+std::vector<LayoutResult> OcrLite::detectLayoutBatch(std::vector<cv::Mat> &pages,
+                                                   float boxScoreThresh, int maxBatch) {
+    TraceSpan span("OcrLite::detectLayoutBatch");
+    Logger("=====Start Batched Layout Detection=====");
+    NetLease lease(*this, NET_LAYOUT);
+    double startTime = getCurrentTime();
+
+    std::vector<LayoutResult> results = layoutNet.getLayoutBoxesBatch(pages, boxScoreThresh, maxBatch);
+
+    double endTime = getCurrentTime();
+    double fullTime = endTime - startTime;
+    Logger("Batched Layout Detection Time(%fms), %zu pages", fullTime, pages.size());
+    Logger("=====End Batched Layout Detection=====");
+
+    return results;
+}
+
+void OcrLite::recognizeLayoutRegions(cv::Mat &src, LayoutResult &layoutResult, int padding,
+                                     float boxScoreThresh, float boxThresh,
+                                     float unClipRatio, bool doAngle, bool mostAngle) {
+    TraceSpan span("OcrLite::recognizeLayoutRegions");
+    StageTimer timer;
+    cv::Rect imgRect(0, 0, src.cols, src.rows);
+    for (auto &layoutBox : layoutResult.layoutBoxes) {
+        if (layoutBox.type == LayoutType::FIGURE || layoutBox.type == LayoutType::TABLE ||
+            layoutBox.type == LayoutType::TABLE_FOOTNOTE) {
+            continue;
+        }
+        cv::Rect cropRect = cv::Rect(layoutBox.boxPoint[0], layoutBox.boxPoint[2]) & imgRect;
+        if (cropRect.width <= 10 || cropRect.height <= 10) {
+            continue;
+        }
+        TraceSpan regionSpan("OcrLite::recognizeRegion");
+        timer.restart();
+        cv::Mat regionImg = src(cropRect).clone();
+        timer.lap(layoutResult.timing.layoutNet.crop, "cropRegion");
+        OcrResult ocrResult = detect(regionImg, padding,
+                                     (std::max)(cropRect.width, cropRect.height),
+                                     boxScoreThresh, boxThresh, unClipRatio, doAngle, mostAngle);
+        layoutBox.ocrText = ocrResult.strRes;
+        layoutBox.hasOcrText = true;
+        layoutResult.timing += ocrResult.timing;
+    }
+}
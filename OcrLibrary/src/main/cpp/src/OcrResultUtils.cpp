@@ -2,6 +2,7 @@
 #include "OcrResultUtils.h"
 
 OcrResultUtils::OcrResultUtils(JNIEnv *env, OcrResult &ocrResult, jobject boxImg) {
+    StageTimer timer;
     jniEnv = env;
 
     jclass jOcrResultClass = env->FindClass("com/benjaminwan/ocrlibrary/OcrResult");
@@ -11,15 +12,18 @@ OcrResultUtils::OcrResultUtils(JNIEnv *env, OcrResult &ocrResult, jobject boxImg
     }
 
     jmethodID jOcrResultConstructor = env->GetMethodID(jOcrResultClass, "<init>",
-                                                       "(DLjava/util/ArrayList;Landroid/graphics/Bitmap;DLjava/lang/String;)V");
+                                                       "(DLjava/util/ArrayList;Landroid/graphics/Bitmap;DLjava/lang/String;Lcom/benjaminwan/ocrlibrary/PipelineTiming;)V");
 
     jobject textBlocks = getTextBlocks(ocrResult.textBlocks);
     jdouble dbNetTime = (jdouble) ocrResult.dbNetTime;
     jdouble detectTime = (jdouble) ocrResult.detectTime;
     jstring jStrRest = jniEnv->NewStringUTF(ocrResult.strRes.c_str());
+    // 耗时对象本身的构造不计入jniMarshal
+    timer.lap(ocrResult.timing.jniMarshal, "newOcrResult");
+    jobject jTiming = newJPipelineTiming(env, ocrResult.timing);
 
     jOcrResult = env->NewObject(jOcrResultClass, jOcrResultConstructor, dbNetTime,
-                                textBlocks, boxImg, detectTime, jStrRest);
+                                textBlocks, boxImg, detectTime, jStrRest, jTiming);
 }
 
 OcrResultUtils::~OcrResultUtils() {
@@ -108,4 +112,53 @@ jfloatArray OcrResultUtils::newJScoreArray(std::vector<float> &scores) {
     jfloatArray jScores = jniEnv->NewFloatArray(scores.size());
     jniEnv->SetFloatArrayRegion(jScores, 0, scores.size(), (jfloat *) scores.data());
     return jScores;
-}
\ No newline at end of file
+}
+static jobject newJStageTiming(JNIEnv *env, StageTiming &timing) {
+    jclass clazz = env->FindClass("com/benjaminwan/ocrlibrary/StageTiming");
+    if (clazz == NULL) {
+        LOGE("StageTiming class is null");
+        return NULL;
+    }
+    jmethodID constructor = env->GetMethodID(clazz, "<init>", "(DD)V");
+    return env->NewObject(clazz, constructor, (jdouble) timing.wallTime, (jdouble) timing.cpuTime);
+}
+
+static jobject newJNetTiming(JNIEnv *env, NetTiming &timing) {
+    jclass clazz = env->FindClass("com/benjaminwan/ocrlibrary/NetTiming");
+    if (clazz == NULL) {
+        LOGE("NetTiming class is null");
+        return NULL;
+    }
+    const char *stage = "Lcom/benjaminwan/ocrlibrary/StageTiming;";
+    std::string signature = "(";
+    for (int i = 0; i < 6; ++i) signature += stage;
+    signature += ")V";
+    jmethodID constructor = env->GetMethodID(clazz, "<init>", signature.c_str());
+    return env->NewObject(clazz, constructor,
+                          newJStageTiming(env, timing.preprocess),
+                          newJStageTiming(env, timing.inference),
+                          newJStageTiming(env, timing.postprocess),
+                          newJStageTiming(env, timing.nms),
+                          newJStageTiming(env, timing.crop),
+                          newJStageTiming(env, timing.render));
+}
+
+jobject newJPipelineTiming(JNIEnv *env, PipelineTiming &timing) {
+    jclass clazz = env->FindClass("com/benjaminwan/ocrlibrary/PipelineTiming");
+    if (clazz == NULL) {
+        LOGE("PipelineTiming class is null");
+        return NULL;
+    }
+    jmethodID constructor = env->GetMethodID(clazz, "<init>",
+                                             "(Lcom/benjaminwan/ocrlibrary/NetTiming;"
+                                             "Lcom/benjaminwan/ocrlibrary/NetTiming;"
+                                             "Lcom/benjaminwan/ocrlibrary/NetTiming;"
+                                             "Lcom/benjaminwan/ocrlibrary/NetTiming;"
+                                             "Lcom/benjaminwan/ocrlibrary/StageTiming;)V");
+    return env->NewObject(clazz, constructor,
+                          newJNetTiming(env, timing.dbNet),
+                          newJNetTiming(env, timing.angleNet),
+                          newJNetTiming(env, timing.crnnNet),
+                          newJNetTiming(env, timing.layoutNet),
+                          newJStageTiming(env, timing.jniMarshal));
+}
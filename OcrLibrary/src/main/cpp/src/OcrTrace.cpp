@@ -0,0 +1,126 @@
+#include "OcrTrace.h"
+#include "OcrUtils.h"
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+std::atomic<bool> OcrTrace::enabled(false);
+
+namespace {
+
+struct TraceEvent {
+    const char *name;
+    double startMs;
+    double endMs;
+};
+
+// 每个线程一个缓冲区；锁只在导出时与写入竞争，平时无争用
+struct ThreadBuffer {
+    long tid;
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+    size_t dropped = 0;
+};
+
+// 单线程最多保留的事件数，超过后丢弃并计数，防止忘记stop时内存无限增长
+const size_t MAX_EVENTS_PER_THREAD = 1 << 20;
+
+std::mutex registryMutex;
+std::vector<std::shared_ptr<ThreadBuffer>> registry;
+double originMs = 0;
+
+ThreadBuffer &threadBuffer() {
+    // 线程退出后缓冲区仍由registry持有，导出时不会悬空
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+        buffer->tid = (long) syscall(SYS_gettid);
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.push_back(buffer);
+    }
+    return *buffer;
+}
+
+}
+
+void OcrTrace::start() {
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (auto &buffer : registry) {
+            std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+            buffer->events.clear();
+            buffer->dropped = 0;
+        }
+        originMs = getCurrentTime();
+    }
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+void OcrTrace::stop() {
+    enabled.store(false, std::memory_order_relaxed);
+}
+
+void OcrTrace::addSpan(const char *name, double startMs, double endMs) {
+    if (!isEnabled()) return;
+    ThreadBuffer &buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.events.size() >= MAX_EVENTS_PER_THREAD) {
+        buffer.dropped++;
+        return;
+    }
+    buffer.events.push_back(TraceEvent{name, startMs, endMs});
+}
+
+bool OcrTrace::writeJson(const std::string &path) {
+    FILE *fp = fopen(path.c_str(), "w");
+    if (fp == NULL) {
+        LOGE("cannot write trace: %s", path.c_str());
+        return false;
+    }
+    long pid = (long) getpid();
+    size_t total = 0;
+    size_t dropped = 0;
+    bool first = true;
+    fprintf(fp, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (auto &buffer : registry) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        if (buffer->events.empty()) continue;
+        fprintf(fp, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %ld, \"tid\": %ld, "
+                    "\"args\": {\"name\": \"%s%ld\"}}",
+                first ? "" : ",\n", pid, buffer->tid, buffer->tid == pid ? "main " : "tid ",
+                buffer->tid);
+        first = false;
+        for (const auto &event : buffer->events) {
+            // ts/dur 单位微秒
+            fprintf(fp, ",\n{\"name\": \"%s\", \"cat\": \"ocr\", \"ph\": \"X\", \"pid\": %ld, "
+                        "\"tid\": %ld, \"ts\": %.3f, \"dur\": %.3f}",
+                    event.name, pid, buffer->tid, (event.startMs - originMs) * 1000.0,
+                    (event.endMs - event.startMs) * 1000.0);
+        }
+        total += buffer->events.size();
+        dropped += buffer->dropped;
+    }
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+    if (dropped > 0) {
+        LOGW("trace buffer full, %zu events dropped", dropped);
+    }
+    LOGI("trace written: %s (%zu events)", path.c_str(), total);
+    return true;
+}
+
+TraceSpan::TraceSpan(const char *name) : name(name), startMs(0) {
+    if (OcrTrace::isEnabled()) {
+        startMs = getCurrentTime();
+    }
+}
+
+TraceSpan::~TraceSpan() {
+    if (startMs > 0) {
+        OcrTrace::addSpan(name, startMs, getCurrentTime());
+    }
+}
@@ -1,11 +1,54 @@
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <cstdio>
+#include <unistd.h>
 #include <opencv2/imgproc.hpp>
 #include "OcrUtils.h"
 #include "clipper.hpp"
+#include "OcrTrace.h"
+#include "NormalizeKernels.h"
 
 double getCurrentTime() {
     return (static_cast<double>(cv::getTickCount())) / cv::getTickFrequency() * 1000;//单位毫秒
 }
 
+double getThreadCpuTime() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+size_t getResidentBytes() {
+    FILE *fp = fopen("/proc/self/statm", "r");
+    if (fp == nullptr) return 0;
+    unsigned long totalPages = 0, residentPages = 0;
+    int n = fscanf(fp, "%lu %lu", &totalPages, &residentPages);
+    fclose(fp);
+    return n == 2 ? (size_t) residentPages * (size_t) sysconf(_SC_PAGESIZE) : 0;
+}
+
+StageTimer::StageTimer() {
+    restart();
+}
+
+void StageTimer::restart() {
+    startWall = getCurrentTime();
+    startCpu = getThreadCpuTime();
+}
+
+void StageTimer::lap(StageTiming &timing, const char *traceName) {
+    double endWall = getCurrentTime();
+    double endCpu = getThreadCpuTime();
+    if (traceName != nullptr) {
+        OcrTrace::addSpan(traceName, startWall, endWall);
+    }
+    timing.wallTime += endWall - startWall;
+    timing.cpuTime += endCpu - startCpu;
+    startWall = endWall;
+    startCpu = endCpu;
+}
+
 ScaleParam getScaleParam(cv::Mat &src, const float scale) {
     int srcWidth = src.cols;
     int srcHeight = src.rows;
@@ -184,6 +227,15 @@ cv::Mat adjustTargetImg(cv::Mat &src, int dstWidth, int dstHeight) {
     return srcFit;
 }
 
+cv::Mat makePadding(cv::Mat &src, const int padding) {
+    if (padding <= 0) return src;
+    cv::Scalar paddingScalar = {255, 255, 255};
+    cv::Mat paddingSrc;
+    cv::copyMakeBorder(src, paddingSrc, padding, padding, padding, padding, cv::BORDER_ISOLATED,
+                       paddingScalar);
+    return paddingSrc;
+}
+
 bool cvPointCompare(cv::Point a, cv::Point b) {
     return a.x < b.x;
 }
@@ -295,16 +347,37 @@ cv::RotatedRect unClip(std::vector<cv::Point2f> box, float unClipRatio) {
 std::vector<float> substractMeanNormalize(cv::Mat &src, const float *meanVals, const float *normVals) {
     auto inputTensorSize = src.cols * src.rows * src.channels();
     std::vector<float> inputTensorValues(inputTensorSize);
-    size_t numChannels = src.channels();
-    size_t imageSize = src.cols * src.rows;
+    substractMeanNormalize(src, meanVals, normVals, inputTensorValues.data());
+    return inputTensorValues;
+}
 
-    for (size_t pid = 0; pid < imageSize; pid++) {
-        for (size_t ch = 0; ch < numChannels; ++ch) {
-            float data = (float) (src.data[pid * numChannels + ch] * normVals[ch] - meanVals[ch] * normVals[ch]);
-            inputTensorValues[ch * imageSize + pid] = data;
-        }
+void substractMeanNormalize(const cv::Mat &src, const float *meanVals, const float *normVals,
+                            float *dst, const NormalizeKernel *kernel) {
+    const int maxChannels = 4;
+    int numChannels = src.channels();
+    if (numChannels > maxChannels) {
+        LOGE("substractMeanNormalize: unsupported channels %d", numChannels);
+        return;
+    }
+    if (kernel == nullptr) {
+        kernel = &getNormalizeKernel();
+    }
+    // (x - mean) * norm 展开成 x * scale + bias
+    float scale[maxChannels];
+    float bias[maxChannels];
+    for (int ch = 0; ch < numChannels; ++ch) {
+        scale[ch] = normVals[ch];
+        bias[ch] = -meanVals[ch] * normVals[ch];
+    }
+    size_t planeSize = (size_t) src.cols * src.rows;
+    if (src.isContinuous()) {
+        kernel->func(src.data, src.cols * src.rows, numChannels, scale, bias, dst, planeSize);
+        return;
+    }
+    for (int y = 0; y < src.rows; ++y) {
+        kernel->func(src.ptr<unsigned char>(y), src.cols, numChannels, scale, bias,
+                     dst + (size_t) y * src.cols, planeSize);
     }
-    return inputTensorValues;
 }
 
 std::vector<int> getAngleIndexes(std::vector<Angle> &angles) {
@@ -377,24 +450,7 @@ std::vector<Ort::AllocatedStringPtr> getOutputNames(Ort::Session *session) {
     return outputNamesPtr;
 }
 
-void *getModelDataFromAssets(AAssetManager *mgr, const char *modelName, int &size) {
-    if (mgr == NULL) {
-        LOGE(" %s", "AAssetManager==NULL");
-        return NULL;
-    }
-    AAsset *asset = AAssetManager_open(mgr, modelName, AASSET_MODE_UNKNOWN);
-    if (asset == NULL) {
-        LOGE(" %s", "asset==NULL");
-        return NULL;
-    }
-    off_t bufferSize = AAsset_getLength(asset);
-    void *modelData = malloc(bufferSize + 1);
-    size = AAsset_read(asset, modelData, bufferSize);
-    AAsset_close(asset);
-    LOGI("model=%s, numBytesRead=%d", modelName, size);
-    return modelData;
-}
-
+#ifdef __ANDROID__
 std::string jstringTostring(JNIEnv *env, jstring input) {
     char *str = NULL;
     jclass clsstring = env->FindClass("java/lang/String");
@@ -411,4 +467,89 @@ std::string jstringTostring(JNIEnv *env, jstring input) {
     env->ReleaseByteArrayElements(barr, ba, 0);
     std::string ret = str;
     return ret;
-}
\ No newline at end of file
+}
+#endif
+
+static std::mutex ortEnvMutex;
+static int ortThreadBudget = 0;
+static bool ortSharedAllocator = false;
+// 有意不释放：静态析构顺序不确定，session可能晚于它销毁
+static Ort::Env *sharedOrtEnv = nullptr;
+
+int resolveThreadBudget(int numThread) {
+    if (numThread > 0) return numThread;
+    int cores = (int) std::thread::hardware_concurrency();
+    return cores > 0 ? cores : 1;
+}
+
+void setOrtThreadBudget(int numThread) {
+    std::lock_guard<std::mutex> lock(ortEnvMutex);
+    numThread = resolveThreadBudget(numThread);
+    if (sharedOrtEnv != nullptr) {
+        if (numThread != ortThreadBudget) {
+            LOGW("ORT global thread pool already created with %d threads, ignore %d",
+                 ortThreadBudget, numThread);
+        }
+        return;
+    }
+    ortThreadBudget = numThread;
+}
+
+int getOrtThreadBudget() {
+    std::lock_guard<std::mutex> lock(ortEnvMutex);
+    return resolveThreadBudget(ortThreadBudget);
+}
+
+void setOrtSharedAllocator(bool enabled) {
+    std::lock_guard<std::mutex> lock(ortEnvMutex);
+    if (sharedOrtEnv != nullptr) {
+        if (enabled != ortSharedAllocator) {
+            LOGW("ORT env already created, shared allocator stays %s", ortSharedAllocator ? "on" : "off");
+        }
+        return;
+    }
+    ortSharedAllocator = enabled;
+}
+
+bool isOrtSharedAllocator() {
+    std::lock_guard<std::mutex> lock(ortEnvMutex);
+    return ortSharedAllocator;
+}
+
+Ort::Env &getOrtEnv() {
+    std::lock_guard<std::mutex> lock(ortEnvMutex);
+    if (sharedOrtEnv == nullptr) {
+        ortThreadBudget = resolveThreadBudget(ortThreadBudget);
+        Ort::ThreadingOptions threadingOptions;
+        // 四个网络都是顺序执行，inter-op池用不到；intra-op池即全部预算
+        threadingOptions.SetGlobalIntraOpNumThreads(ortThreadBudget);
+        threadingOptions.SetGlobalInterOpNumThreads(1);
+        // 不自旋等待：并发请求时空转线程会抢占其它调用的核，造成延迟抖动
+        threadingOptions.SetGlobalSpinControl(0);
+        sharedOrtEnv = new Ort::Env(threadingOptions, ORT_LOGGING_LEVEL_ERROR, "RapidOcr");
+        LOGI("ORT global thread pool: intra=%d inter=1", ortThreadBudget);
+        if (ortSharedAllocator) {
+            // arena参数取ORT默认值（-1/0）
+            Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+            Ort::ArenaCfg arenaCfg(0, -1, -1, -1);
+            sharedOrtEnv->CreateAndRegisterAllocator(memoryInfo, arenaCfg);
+            LOGI("ORT shared CPU arena registered on env");
+        }
+    }
+    return *sharedOrtEnv;
+}
+
+Ort::RunOptions getRunOptions(const char *netName, bool profiling, int &runCount) {
+    if (!profiling) return Ort::RunOptions{nullptr};
+    Ort::RunOptions runOptions;
+    std::string tag = std::string(netName) + "#" + std::to_string(runCount++);
+    runOptions.SetRunTag(tag.c_str());
+    return runOptions;
+}
+
+std::string endSessionProfiling(Ort::Session *session, bool &profiling) {
+    if (!profiling || session == nullptr) return "";
+    profiling = false;
+    Ort::AllocatorWithDefaultOptions allocator;
+    return std::string(session->EndProfilingAllocated(allocator).get());
+}
@@ -0,0 +1,114 @@
+#include "TensorBinding.h"
+#include "OcrUtils.h"
+#include <numeric>
+#include <string>
+
+// 超过这么多种输入形状后清空输出形状表，CrnnNet的文本行宽度种类有限，正常达不到
+static const size_t MAX_CACHED_SHAPES = 512;
+
+// ORT在预绑定输出的形状与实际输出不符时报 "Shape mismatch attempting to re-use buffer"，
+// 只有这类错误说明输出形状依赖输入内容；OOM、输入非法、被取消等其它错误原样抛出
+static bool isOutputShapeMismatch(const Ort::Exception &e) {
+    std::string message = e.what();
+    return message.find("Shape mismatch") != std::string::npos ||
+           message.find("shape mismatch") != std::string::npos;
+}
+
+static size_t shapeCount(const std::vector<int64_t> &shape) {
+    return (size_t) std::accumulate(shape.begin(), shape.end(), (int64_t) 1,
+                                    std::multiplies<int64_t>());
+}
+
+void TensorBinding::init(Ort::Session *session) {
+    reset();
+    this->session = session;
+    if (session == nullptr) return;
+    inputNamesPtr = getInputNames(session);
+    outputNamesPtr = getOutputNames(session);
+    binding.reset(new Ort::IoBinding(*session));
+}
+
+void TensorBinding::reset() {
+    binding.reset();
+    session = nullptr;
+    inputNamesPtr.clear();
+    outputNamesPtr.clear();
+    ortOutputs.clear();
+    outputShapes.clear();
+}
+
+float *TensorBinding::inputBuffer(const std::vector<int64_t> &shape) {
+    size_t count = shapeCount(shape);
+    if (inputData.size() < count) {
+        inputData.resize(count);
+    }
+    inputShape = shape;
+    return inputData.data();
+}
+
+const float *TensorBinding::run(const Ort::RunOptions &runOptions,
+                                std::vector<int64_t> &outputShape) {
+    Ort::Value inputTensor = Ort::Value::CreateTensor<float>(memoryInfo, inputData.data(),
+                                                             shapeCount(inputShape),
+                                                             inputShape.data(),
+                                                             inputShape.size());
+    binding->ClearBoundInputs();
+    binding->ClearBoundOutputs();
+    binding->BindInput(inputName(), inputTensor);
+
+    auto it = outputShapes.find(inputShape);
+    if (it != outputShapes.end() && !it->second.empty()) {
+        // 输出形状已知：直接写进复用的缓冲区
+        size_t count = shapeCount(it->second);
+        if (outputData.size() < count) {
+            outputData.resize(count);
+        }
+        Ort::Value outputTensor = Ort::Value::CreateTensor<float>(memoryInfo, outputData.data(),
+                                                                  count, it->second.data(),
+                                                                  it->second.size());
+        binding->BindOutput(outputName(), outputTensor);
+        try {
+            session->Run(runOptions, *binding);
+            ortOutputs.clear();
+            outputShape = it->second;
+            return outputData.data();
+        } catch (const Ort::Exception &e) {
+            if (!isOutputShapeMismatch(e)) throw;
+            // 输出形状还依赖输入内容（如图内NMS），该输入形状以后都交给ORT分配
+            LOGW("output shape is not fixed for this input, fallback to ORT allocation: %s",
+                 e.what());
+            it->second.clear();
+            binding->ClearBoundOutputs();
+        }
+    }
+
+    // 第一次见到该输入形状，或输出形状不固定：由ORT分配输出
+    binding->BindOutput(outputName(), memoryInfo);
+    session->Run(runOptions, *binding);
+    ortOutputs = binding->GetOutputValues();
+    outputShape = ortOutputs.front().GetTensorTypeAndShapeInfo().GetShape();
+    if (it == outputShapes.end()) {
+        if (outputShapes.size() >= MAX_CACHED_SHAPES) {
+            outputShapes.clear();
+        }
+        // 记下形状，下次预分配
+        outputShapes[inputShape] = outputShape;
+    }
+    return ortOutputs.front().GetTensorData<float>();
+}
+
+void TensorBinding::trimBuffers(size_t maxInputCount) {
+    if (inputData.size() <= maxInputCount) return;
+    LOGI("release oversized tensor buffers: %zu input floats", inputData.size());
+    std::vector<float>().swap(inputData);
+    std::vector<float>().swap(outputData);
+    ortOutputs.clear();
+}
+
+const char *TensorBinding::inputName() const {
+    return inputNamesPtr.front().get();
+}
+
+const char *TensorBinding::outputName() const {
+    return outputNamesPtr.front().get();
+}
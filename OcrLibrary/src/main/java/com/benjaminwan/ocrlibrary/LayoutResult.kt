@@ -27,10 +27,21 @@ data class LayoutBox(
     val typeName: String
 ) : Parcelable
 
+// 版面结果由级联的哪一级产生，顺序与native LayoutStage一致
+enum class LayoutStage {
+    FULL,       // 未开启级联，完整模型
+    FAST,       // 快速模型的结果通过了放行条件
+    ESCALATED   // 快速模型未通过，改用完整模型
+}
+
 @Parcelize
 data class LayoutResult(
     val layoutNetTime: Double,
     val layoutBoxes: ArrayList<LayoutBox>,
     val layoutImg: Bitmap,
-    val markdown: String
-) : Parcelable
\ No newline at end of file
+    val markdown: String,
+    val timing: PipelineTiming = PipelineTiming(),
+    val stage: Int = LayoutStage.FULL.ordinal
+) : Parcelable {
+    val layoutStage: LayoutStage get() = LayoutStage.values()[stage]
+}
\ No newline at end of file
@@ -15,9 +15,33 @@ data class OcrResult(
     val textBlocks: ArrayList<TextBlock>,
     var boxImg: Bitmap,
     var detectTime: Double,
-    var strRes: String
+    var strRes: String,
+    val timing: PipelineTiming = PipelineTiming()
 ) : Parcelable, OcrOutput()
 
+// 单个阶段耗时(ms)：墙钟时间与调用线程CPU时间
+@Parcelize
+data class StageTiming(val wallTime: Double = 0.0, val cpuTime: Double = 0.0) : Parcelable
+
+@Parcelize
+data class NetTiming(
+    val preprocess: StageTiming = StageTiming(),
+    val inference: StageTiming = StageTiming(),
+    val postprocess: StageTiming = StageTiming(),
+    val nms: StageTiming = StageTiming(),
+    val crop: StageTiming = StageTiming(),
+    val render: StageTiming = StageTiming()
+) : Parcelable
+
+@Parcelize
+data class PipelineTiming(
+    val dbNet: NetTiming = NetTiming(),
+    val angleNet: NetTiming = NetTiming(),
+    val crnnNet: NetTiming = NetTiming(),
+    val layoutNet: NetTiming = NetTiming(),
+    val jniMarshal: StageTiming = StageTiming()
+) : Parcelable
+
 @Parcelize
 data class Point(var x: Int, var y: Int) : Parcelable
 
@@ -719,10 +719,9 @@ class GalleryActivity : AppCompatActivity(), View.OnClickListener, SeekBar.OnSee
         }
 
         // 先创建包含新boxes的中间result
-        val newLayoutResult = com.benjaminwan.ocrlibrary.LayoutResult(
-            layoutNetTime = layoutResult.layoutNetTime,
+        // copy保留stage、timing等其余字段
+        val newLayoutResult = layoutResult.copy(
             layoutBoxes = ArrayList(updatedLayoutBoxes),
-            layoutImg = layoutResult.layoutImg,
             markdown = ""
         )
 
@@ -730,12 +729,7 @@ class GalleryActivity : AppCompatActivity(), View.OnClickListener, SeekBar.OnSee
         val markdown = generateRealMarkdown(newLayoutResult, figureResults)
 
         // 返回更新后的LayoutResult
-        return com.benjaminwan.ocrlibrary.LayoutResult(
-            layoutNetTime = layoutResult.layoutNetTime,
-            layoutBoxes = ArrayList(updatedLayoutBoxes),
-            layoutImg = layoutResult.layoutImg,
-            markdown = markdown
-        )
+        return newLayoutResult.copy(markdown = markdown)
     }
 
     // 保存figure图像到文件并返回文件路径
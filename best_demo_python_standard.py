@@ -25,7 +25,8 @@ DOCLAYOUT_CLASSES = [
 class DocLayoutAnalyzer:
     """DOCLAYOUT_DOCSTRUCTBENCH 标准实现类"""
 
-    def __init__(self, model_path: str, conf_threshold: float = 0.2, iou_threshold: float = 0.4):
+    def __init__(self, model_path: str, conf_threshold: float = 0.2, iou_threshold: float = 0.4,
+                 rect_stride: int = 0):
         """
         初始化文档布局分析器
 
@@ -33,11 +34,13 @@ class DocLayoutAnalyzer:
             model_path: ONNX模型路径
             conf_threshold: 置信度阈值
             iou_threshold: NMS IoU阈值
+            rect_stride: >0时只把短边补到该步长的倍数（如1024x736），需要动态输入的模型
         """
         self.model_path = model_path
         self.conf_threshold = conf_threshold
         self.iou_threshold = iou_threshold
         self.input_size = (1024, 1024)  # DOCLAYOUT_DOCSTRUCTBENCH使用1024x1024
+        self.rect_stride = rect_stride
 
         # 初始化ONNX Runtime
         self.session = None
@@ -85,16 +88,22 @@ class DocLayoutAnalyzer:
         # 2. 计算新的尺寸
         new_shape = (int(original_shape[1] * gain), int(original_shape[0] * gain))
 
-        # 3. 计算padding（与YOLOv8标准一致）
-        pad_w = round((self.input_size[1] - new_shape[0]) / 2 - 0.1)
-        pad_h = round((self.input_size[0] - new_shape[1]) / 2 - 0.1)
+        # 3. 计算padding（与YOLOv8标准一致）；rect模式下输入只补到步长的倍数，两侧padding可能差1
+        input_h, input_w = self.input_size
+        if self.rect_stride > 0:
+            input_w = -(-new_shape[0] // self.rect_stride) * self.rect_stride
+            input_h = -(-new_shape[1] // self.rect_stride) * self.rect_stride
+        pad_w = round((input_w - new_shape[0]) / 2 - 0.1)
+        pad_h = round((input_h - new_shape[1]) / 2 - 0.1)
         padding = (pad_w, pad_h)
+        pad_right = pad_w if self.rect_stride <= 0 else input_w - new_shape[0] - pad_w
+        pad_bottom = pad_h if self.rect_stride <= 0 else input_h - new_shape[1] - pad_h
 
         # 4. Resize保持宽高比
         resized = cv2.resize(image, new_shape, interpolation=cv2.INTER_LINEAR)
 
         # 5. 添加padding（使用114,114,114灰色，与YOLO标准一致）
-        padded = cv2.copyMakeBorder(resized, pad_h, pad_h, pad_w, pad_w,
+        padded = cv2.copyMakeBorder(resized, pad_h, pad_bottom, pad_w, pad_right,
                                    cv2.BORDER_CONSTANT, value=(114, 114, 114))
 
         # 6. BGR2RGB + 归一化
@@ -107,7 +116,7 @@ class DocLayoutAnalyzer:
         # 8. 添加batch维度
         batched = np.expand_dims(chw, axis=0)
 
-        print(f"🔧 Preprocess: {original_shape[::-1]} -> {new_shape} -> {self.input_size}")
+        print(f"🔧 Preprocess: {original_shape[::-1]} -> {new_shape} -> {padded.shape[1::-1]}")
         print(f"📏 Gain: {gain:.3f}, Padding: {padding}")
 
         return batched, gain, padding
@@ -389,6 +398,8 @@ def main():
     parser.add_argument('--report', type=str, default='detection_report.md', help='输出报告路径')
     parser.add_argument('--conf', type=float, default=0.2, help='置信度阈值')
     parser.add_argument('--iou', type=float, default=0.4, help='NMS IoU阈值')
+    parser.add_argument('--rect', action='store_true', help='短边只补到32的倍数（需要动态输入的模型）')
+    parser.add_argument('--json', type=str, default='', help='把检测框写成JSON，供scripts/compare_layout.py比对')
 
     args = parser.parse_args()
 
@@ -403,7 +414,7 @@ def main():
 
     # 创建分析器
     print("🚀 Initializing DOCLAYOUT_DOCSTRUCTBENCH analyzer...")
-    analyzer = DocLayoutAnalyzer(args.model, args.conf, args.iou)
+    analyzer = DocLayoutAnalyzer(args.model, args.conf, args.iou, 32 if args.rect else 0)
 
     # 读取图像
     print("📖 Loading image...")
@@ -416,6 +427,11 @@ def main():
     print("🔍 Running detection...")
     results = analyzer.detect(image)
 
+    if args.json:
+        with open(args.json, 'w', encoding='utf-8') as f:
+            json.dump({'boxes': [{'class_id': d['class_id'], 'score': d['confidence'], 'bbox': d['bbox']}
+                                 for d in results['detections']]}, f)
+
     # 可视化结果
     print("🎨 Visualizing results...")
     analyzer.visualize_results(image, results, args.output)
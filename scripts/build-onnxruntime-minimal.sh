@@ -0,0 +1,137 @@
+#!/bin/bash
+# 按发布的四个模型实际用到的算子裁剪 onnxruntime，编译成静态库，供 -DOCR_ORT_STATIC=ON 静态链接进 RapidOcr
+# Build a reduced-operator static onnxruntime for the shipped models
+#
+# 用法: scripts/build-onnxruntime-minimal.sh <onnxruntime源码目录> <模型目录> [android|linux|all]
+# 需要与源码同版本的 onnxruntime python 包（pip install onnxruntime==x.y.z），用来生成优化后的图
+# 输出: OcrLibrary/src/main/onnxruntime-static/{armeabi-v7a,arm64-v8a,x86,x86_64,linux}
+
+set -e
+
+if [ $# -lt 2 ]; then
+    echo "Usage: $0 <onnxruntime source dir> <models dir> [android|linux|all]"
+    exit 1
+fi
+
+ORT_SRC=$(cd "$1" && pwd)
+MODELS_DIR=$(cd "$2" && pwd)
+TARGET=${3:-all}
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+OUT_DIR="$ROOT/OcrLibrary/src/main/onnxruntime-static"
+WORK_DIR="$OUT_DIR/work"
+CONFIG="$OUT_DIR/required_operators.config"
+ANDROID_SDK=${ANDROID_SDK:-$HOME/Library/Android/sdk}
+ANDROID_NDK=${ANDROID_NDK:-$ANDROID_SDK/ndk/25.1.8937393}
+
+# 与 OcrEngine.kt 一致的模型文件
+MODELS="ch_PP-OCRv3_det_infer.onnx ch_ppocr_mobile_v2.0_cls_infer.onnx ch_PP-OCRv3_rec_infer.onnx doclayout_yolo_docstructbench_imgsz1024.onnx"
+
+# 1. 算子清单：原始图 + ORT_ENABLE_EXTENDED 优化后的图（含FusedConv等融合算子）取并集，
+#    两种情况（未命中/命中优化缓存）都能创建session
+function makeOpsConfig(){
+    rm -rf "$WORK_DIR" && mkdir -p "$WORK_DIR/onnx" "$WORK_DIR/ort"
+    for model in $MODELS; do
+        cp "$MODELS_DIR/$model" "$WORK_DIR/onnx/"
+    done
+    python3 - "$WORK_DIR" <<'EOF'
+import os, sys
+import onnxruntime as ort
+work = sys.argv[1]
+for name in sorted(os.listdir(os.path.join(work, "onnx"))):
+    so = ort.SessionOptions()
+    so.graph_optimization_level = ort.GraphOptimizationLevel.ORT_ENABLE_EXTENDED
+    so.optimized_model_filepath = os.path.join(work, "ort", name[:-5] + ".ort")
+    so.add_session_config_entry("session.save_model_format", "ORT")
+    ort.InferenceSession(os.path.join(work, "onnx", name), so, providers=["CPUExecutionProvider"])
+EOF
+    python3 "$ORT_SRC/tools/python/create_reduced_build_config.py" --format ONNX "$WORK_DIR/onnx" "$WORK_DIR/onnx.config"
+    python3 "$ORT_SRC/tools/python/create_reduced_build_config.py" --format ORT "$WORK_DIR/ort" "$WORK_DIR/ort.config"
+    python3 - "$WORK_DIR/onnx.config" "$WORK_DIR/ort.config" "$CONFIG" <<'EOF'
+import sys
+ops = {}
+for path in sys.argv[1:3]:
+    for line in open(path):
+        line = line.strip()
+        if not line or line.startswith("#"):
+            continue
+        domain, opset, names = line.split(";")
+        ops.setdefault((domain, opset), set()).update(names.split(","))
+with open(sys.argv[3], "w") as f:
+    f.write("# RapidOcr: ops used by det/cls/rec/layout models, original and ORT_ENABLE_EXTENDED optimized\n")
+    for (domain, opset), names in sorted(ops.items()):
+        f.write("%s;%s;%s\n" % (domain, opset, ",".join(sorted(names))))
+EOF
+    echo "ops config: $CONFIG"
+    cat "$CONFIG"
+}
+
+# 2. 把构建目录里的各个静态库合并成一个 libonnxruntime.a，并生成 OnnxRuntimeConfig.cmake
+function packageStatic(){
+    local buildDir=$1
+    local outDir=$2
+    local ar=$3
+    rm -rf "$outDir" && mkdir -p "$outDir/lib" "$outDir/include"
+    local mri="$buildDir/merge.mri"
+    echo "create $outDir/lib/libonnxruntime.a" > "$mri"
+    find "$buildDir/MinSizeRel" -name "*.a" | grep -v -E "test|gtest|gmock|benchmark|mocked" | sort | while read lib; do
+        echo "addlib $lib" >> "$mri"
+    done
+    echo "save" >> "$mri"
+    echo "end" >> "$mri"
+    "$ar" -M < "$mri"
+    cp -r "$ORT_SRC/include/onnxruntime" "$outDir/include/"
+    cat > "$outDir/OnnxRuntimeConfig.cmake" <<'EOF'
+set(OnnxRuntime_INCLUDE_DIRS "${CMAKE_CURRENT_LIST_DIR}/include")
+include_directories(${OnnxRuntime_INCLUDE_DIRS})
+set(OnnxRuntime_LIBS onnxruntime)
+set(OnnxRuntime_STATIC ON)
+add_library(${OnnxRuntime_LIBS} STATIC IMPORTED)
+set_target_properties(${OnnxRuntime_LIBS} PROPERTIES IMPORTED_LOCATION ${CMAKE_CURRENT_LIST_DIR}/lib/libonnxruntime.a)
+if (ANDROID)
+    set_target_properties(${OnnxRuntime_LIBS} PROPERTIES INTERFACE_LINK_LIBRARIES "log;dl")
+else ()
+    set_target_properties(${OnnxRuntime_LIBS} PROPERTIES INTERFACE_LINK_LIBRARIES "pthread;dl")
+endif ()
+EOF
+    ls -l "$outDir/lib/libonnxruntime.a"
+}
+
+function buildOrt(){
+    local name=$1
+    shift
+    local buildDir="$WORK_DIR/build_$name"
+    cd "$ORT_SRC"
+    ./build.sh --build_dir "$buildDir" --config MinSizeRel --parallel --skip_tests \
+    --include_ops_by_config "$CONFIG" --disable_ml_ops \
+    --cmake_extra_defines onnxruntime_BUILD_UNIT_TESTS=OFF \
+    CMAKE_C_FLAGS="-ffunction-sections -fdata-sections" \
+    CMAKE_CXX_FLAGS="-ffunction-sections -fdata-sections" \
+    "$@"
+    cd - > /dev/null
+}
+
+function buildAndroid(){
+    local abi=$1
+    local api=$2
+    buildOrt "android_$abi" --android --android_sdk_path "$ANDROID_SDK" --android_ndk_path "$ANDROID_NDK" \
+    --android_abi "$abi" --android_api "$api"
+    local ar=$(ls "$ANDROID_NDK"/toolchains/llvm/prebuilt/*/bin/llvm-ar | head -1)
+    packageStatic "$WORK_DIR/build_android_$abi" "$OUT_DIR/$abi" "$ar"
+}
+
+function buildLinux(){
+    buildOrt "linux"
+    packageStatic "$WORK_DIR/build_linux" "$OUT_DIR/linux" ar
+}
+
+makeOpsConfig
+if [ "$TARGET" == "android" ] || [ "$TARGET" == "all" ]; then
+    buildAndroid "armeabi-v7a" 21
+    buildAndroid "arm64-v8a" 21
+    buildAndroid "x86" 21
+    buildAndroid "x86_64" 21
+fi
+if [ "$TARGET" == "linux" ] || [ "$TARGET" == "all" ]; then
+    buildLinux
+fi
+echo "done: $OUT_DIR"
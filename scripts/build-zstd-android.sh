@@ -0,0 +1,38 @@
+#!/usr/bin/env bash
+# build zstd static library for the compressed model assets (*.onnx.zst)
+# 在zstd源码根目录运行，输出到 OcrLibrary/src/main/zstd/<abi>/{include,lib}
+
+export ANDROID_NDK=${ANDROID_NDK:-/Users/mywork/android-sdk-macosx/ndk-bundle}
+OUT_DIR=${OUT_DIR:-$(cd "$(dirname "$0")/.." && pwd)/OcrLibrary/src/main/zstd}
+
+function cmakeParams() {
+  mkdir -p "build-android-$1"
+  pushd "build-android-$1"
+  cmake -DCMAKE_BUILD_TYPE=Release \
+    -DCMAKE_INSTALL_PREFIX="$OUT_DIR/$1" \
+    -DCMAKE_TOOLCHAIN_FILE="$ANDROID_NDK/build/cmake/android.toolchain.cmake" \
+    -DANDROID_ABI="$1" -DANDROID_PLATFORM=android-21 \
+    -DZSTD_BUILD_STATIC=ON -DZSTD_BUILD_SHARED=OFF -DZSTD_BUILD_PROGRAMS=OFF \
+    -DZSTD_BUILD_TESTS=OFF -DZSTD_LEGACY_SUPPORT=OFF -DZSTD_MULTITHREAD_SUPPORT=OFF \
+    -DCMAKE_POSITION_INDEPENDENT_CODE=ON \
+    ../build/cmake
+  cmake --build . --config Release -j $NUM_THREADS
+  cmake --build . --config Release --target install
+  popd
+}
+
+sysOS=$(uname -s)
+NUM_THREADS=1
+
+if [ $sysOS == "Darwin" ]; then
+  NUM_THREADS=$(sysctl -n hw.ncpu)
+elif [ $sysOS == "Linux" ]; then
+  NUM_THREADS=$(grep ^processor /proc/cpuinfo | wc -l)
+else
+  echo "Other OS: $sysOS"
+fi
+
+cmakeParams "armeabi-v7a"
+cmakeParams "arm64-v8a"
+cmakeParams "x86"
+cmakeParams "x86_64"
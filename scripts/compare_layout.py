@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""
+比对两份版面检测结果（RapidOcrCli --layout --json 与 best_demo_python_standard.py --json 的输出）
+
+按类别贪心匹配 IoU 最大的框，报告未匹配的框和匹配框坐标的最大/平均偏差。
+C++ 端 resize 尺寸四舍五入、Python 端截断，两边的 padding 最多差 1 个输入像素，
+还原到原图后偏差约为 1/gain 像素，默认容差按此取。
+
+用法:
+    RapidOcrCli --models DIR --image page.jpg --layout --layoutRect --json cpp.json
+    python3 best_demo_python_standard.py --model layout.onnx --image page.jpg --rect --json py.json
+    python3 scripts/compare_layout.py cpp.json py.json
+"""
+
+import argparse
+import json
+import sys
+
+
+def iou(a, b):
+    ix = max(0, min(a[2], b[2]) - max(a[0], b[0]))
+    iy = max(0, min(a[3], b[3]) - max(a[1], b[1]))
+    inter = ix * iy
+    union = (a[2] - a[0]) * (a[3] - a[1]) + (b[2] - b[0]) * (b[3] - b[1]) - inter
+    return inter / union if union > 0 else 0.0
+
+
+def match(boxes_a, boxes_b, min_iou):
+    used = [False] * len(boxes_b)
+    pairs = []
+    unmatched_a = []
+    for a in sorted(boxes_a, key=lambda box: -box["score"]):
+        best, best_iou = -1, min_iou
+        for j, b in enumerate(boxes_b):
+            if used[j] or b["class_id"] != a["class_id"]:
+                continue
+            overlap = iou(a["bbox"], b["bbox"])
+            if overlap >= best_iou:
+                best, best_iou = j, overlap
+        if best < 0:
+            unmatched_a.append(a)
+        else:
+            used[best] = True
+            pairs.append((a, boxes_b[best]))
+    unmatched_b = [b for j, b in enumerate(boxes_b) if not used[j]]
+    return pairs, unmatched_a, unmatched_b
+
+
+def main():
+    parser = argparse.ArgumentParser(description="compare two layout JSON results")
+    parser.add_argument("a")
+    parser.add_argument("b")
+    parser.add_argument("--iou", type=float, default=0.5, help="最小匹配IoU")
+    parser.add_argument("--tol", type=float, default=4.0, help="允许的最大坐标偏差（原图像素）")
+    args = parser.parse_args()
+
+    boxes_a = json.load(open(args.a))["boxes"]
+    boxes_b = json.load(open(args.b))["boxes"]
+    pairs, unmatched_a, unmatched_b = match(boxes_a, boxes_b, args.iou)
+
+    deltas = [abs(x - y) for a, b in pairs for x, y in zip(a["bbox"], b["bbox"])]
+    max_delta = max(deltas) if deltas else 0
+    mean_delta = sum(deltas) / len(deltas) if deltas else 0.0
+    print("%s: %d boxes, %s: %d boxes, matched %d" % (args.a, len(boxes_a), args.b, len(boxes_b),
+                                                      len(pairs)))
+    print("coordinate delta: max %.1f px, mean %.2f px" % (max_delta, mean_delta))
+    for box in unmatched_a:
+        print("only in %s: %s" % (args.a, box))
+    for box in unmatched_b:
+        print("only in %s: %s" % (args.b, box))
+
+    ok = not unmatched_a and not unmatched_b and max_delta <= args.tol
+    print("OK" if ok else "MISMATCH")
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,48 @@
+#!/usr/bin/env python3
+"""
+把识别字表 ppocr_keys_v1.txt 编译成可直接 mmap 的连续字表（Vocabulary.h 中的布局）
+
+CrnnNet 加载编译字表时不再逐行解析、不再为每个字符分配字符串，CTC 解码按下标直接取 UTF-8 字节。
+与文本字表的解析规则一致：按 '\\n' 分行，首部补 blank("#")，尾部补空格。
+
+用法:
+    python3 scripts/compile_vocab.py DocLayoutSdk/src/main/assets/ppocr_keys_v1.txt \\
+        DocLayoutSdk/src/main/assets/ppocr_keys_v1.vocab
+"""
+
+import argparse
+import struct
+
+MAGIC = b"OCRV"
+VERSION = 1
+
+
+def compile_vocab(text):
+    lines = text.split(b"\n")
+    # 与std::getline一致：末尾换行不产生空行
+    if lines and lines[-1] == b"":
+        lines.pop()
+    keys = [b"#"] + lines + [b" "]
+    offsets = [0]
+    for key in keys:
+        offsets.append(offsets[-1] + len(key))
+    header = MAGIC + struct.pack("<II", VERSION, len(keys))
+    return header + struct.pack("<%dI" % len(offsets), *offsets) + b"".join(keys)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("keys", help="文本字表，每行一个字符")
+    parser.add_argument("output", help="输出的编译字表")
+    args = parser.parse_args()
+    with open(args.keys, "rb") as f:
+        blob = compile_vocab(f.read())
+    with open(args.output, "wb") as f:
+        f.write(blob)
+    count = struct.unpack_from("<I", blob, 8)[0]
+    print("%s: %d keys, %d bytes" % (args.output, count, len(blob)))
+
+
+if __name__ == "__main__":
+    main()
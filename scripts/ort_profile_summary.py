@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""
+汇总 ONNX Runtime profiling 输出（OcrLite::setProfilePrefix / RapidOcrCli --profile 生成的json）
+
+按算子类型和节点统计 kernel 耗时，用来判断 doclayout_yolo 1024x1024 是卷积为主还是检测头为主，
+以及 PP-OCRv3 det/rec 的热点算子。
+
+用法:
+    python3 scripts/ort_profile_summary.py prof_layout_2025-01-01_12-00-00.json
+    python3 scripts/ort_profile_summary.py prof_*.json --skip-runs 1 --top 15
+    python3 scripts/ort_profile_summary.py prof_layout_*.json --head-prefix /model.10/
+"""
+
+import argparse
+import json
+from collections import defaultdict
+
+
+def load_events(path):
+    with open(path) as f:
+        data = json.load(f)
+    # 老版本ORT输出是事件列表，新版本可能包在traceEvents里
+    if isinstance(data, dict):
+        data = data.get("traceEvents", [])
+    return data
+
+
+def split_runs(events):
+    """返回 model_run 区间列表 [(start, end)]，按时间排序"""
+    runs = [(e["ts"], e["ts"] + e["dur"]) for e in events
+            if e.get("cat") == "Session" and e.get("name") == "model_run"]
+    return sorted(runs)
+
+
+def run_index(ts, runs):
+    for i, (start, end) in enumerate(runs):
+        if start <= ts <= end:
+            return i
+    return -1
+
+
+def summarize(path, skip_runs, top, head_prefixes):
+    events = load_events(path)
+    runs = split_runs(events)
+    if skip_runs >= len(runs):
+        # 只跑了一次时没有可跳过的warm-up，全部保留
+        skip_runs = 0
+    kept_runs = set(range(skip_runs, len(runs)))
+
+    by_op = defaultdict(lambda: [0.0, 0])
+    by_node = defaultdict(lambda: [0.0, 0, ""])
+    head_us = 0.0
+    kernel_us = 0.0
+    for e in events:
+        if e.get("cat") != "Node" or not e.get("name", "").endswith("_kernel_time"):
+            continue
+        if runs and run_index(e["ts"], runs) not in kept_runs:
+            continue
+        node = e["name"][:-len("_kernel_time")]
+        op = e.get("args", {}).get("op_name", "?")
+        dur = float(e["dur"])
+        kernel_us += dur
+        by_op[op][0] += dur
+        by_op[op][1] += 1
+        by_node[node][0] += dur
+        by_node[node][1] += 1
+        by_node[node][2] = op
+        if any(node.startswith(p) for p in head_prefixes):
+            head_us += dur
+
+    num_runs = max(len(kept_runs), 1) if runs else 1
+    run_us = sum(end - start for i, (start, end) in enumerate(runs) if i in kept_runs)
+
+    print("=" * 80)
+    print(path)
+    print("runs: %d (skipped %d)  model_run avg: %.3f ms  kernel avg: %.3f ms"
+          % (len(kept_runs), skip_runs, run_us / num_runs / 1000.0,
+             kernel_us / num_runs / 1000.0))
+    if kernel_us <= 0:
+        print("no kernel events")
+        return
+
+    print("\n-- by op type --")
+    print("%-28s %12s %8s %8s" % ("op", "avg ms/run", "share", "calls"))
+    for op, (dur, count) in sorted(by_op.items(), key=lambda kv: -kv[1][0])[:top]:
+        print("%-28s %12.3f %7.1f%% %8d" % (op, dur / num_runs / 1000.0, dur * 100.0 / kernel_us,
+                                            count // num_runs))
+
+    print("\n-- by node --")
+    print("%-52s %-14s %10s %7s" % ("node", "op", "avg ms", "share"))
+    for node, (dur, count, op) in sorted(by_node.items(), key=lambda kv: -kv[1][0])[:top]:
+        name = node if len(node) <= 52 else "..." + node[-49:]
+        print("%-52s %-14s %10.3f %6.1f%%" % (name, op, dur / num_runs / 1000.0,
+                                              dur * 100.0 / kernel_us))
+
+    if head_prefixes:
+        print("\n-- head vs backbone --")
+        print("head (%s): %.3f ms/run (%.1f%%)" % (", ".join(head_prefixes),
+                                                  head_us / num_runs / 1000.0,
+                                                  head_us * 100.0 / kernel_us))
+        rest = kernel_us - head_us
+        print("rest: %.3f ms/run (%.1f%%)" % (rest / num_runs / 1000.0, rest * 100.0 / kernel_us))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Summarize ONNX Runtime profiling json")
+    parser.add_argument("files", nargs="+", help="profile json files")
+    parser.add_argument("--skip-runs", type=int, default=1,
+                        help="ignore the first N model_run calls (warm-up), default 1")
+    parser.add_argument("--top", type=int, default=20, help="rows per table, default 20")
+    parser.add_argument("--head-prefix", action="append", default=[],
+                        help="node name prefix counted as detection head, repeatable")
+    args = parser.parse_args()
+    for path in args.files:
+        summarize(path, args.skip_runs, args.top, args.head_prefix)
+
+
+if __name__ == "__main__":
+    main()